@@ -0,0 +1,141 @@
+// Benchmark da Fila em buffer circular contra a lista encadeada que ela
+// substituiu, com profundidades de 10^3 a 10^6 pacientes. É um programa à
+// parte, compilado como o simulador:
+//   g++ -std=c++17 -O2 -o bench_fila src/BenchFila.cpp && ./bench_fila
+// Para cada profundidade a fila é enchida, passa por OPERACOES ciclos de
+// desenfileirar e reenfileirar o mesmo paciente (a profundidade não muda) e
+// é esvaziada. O tempo mostrado é o melhor de REPETICOES rodadas, em
+// nanossegundos por operação.
+
+#include <chrono>
+#include <cstdio>
+#include "Fila.cpp"
+
+// A Fila FIFO como era antes do buffer circular: um nó alocado por
+// enfileira e liberado por desenfileira, com as mesmas estatísticas
+class FilaLista {
+private:
+    struct No {
+        int paciente;
+        Tempo tempoEntradaFila;
+        No* proximo;
+
+        No(int p, Tempo tempo) : paciente(p), tempoEntradaFila(tempo), proximo(nullptr) {}
+    };
+
+    No* inicio;
+    No* fim;
+    int tamanho;
+    Tempo tempoTotalEspera;
+    int pacientesAtendidos;
+    int* historicoDeTamanho;
+    int capacidadeHistorico;
+    int posicaoHistorico;
+
+    void registraTamanho() {
+        if(posicaoHistorico < capacidadeHistorico) {
+            historicoDeTamanho[posicaoHistorico++] = tamanho;
+        }
+    }
+
+public:
+    FilaLista(int capacidadeHistorico = 1000)
+        : inicio(nullptr), fim(nullptr), tamanho(0), tempoTotalEspera(0), pacientesAtendidos(0),
+          capacidadeHistorico(capacidadeHistorico), posicaoHistorico(0) {
+        historicoDeTamanho = new int[capacidadeHistorico];
+    }
+
+    ~FilaLista() {
+        while(inicio != nullptr) {
+            No* temp = inicio;
+            inicio = inicio->proximo;
+            delete temp;
+        }
+        delete[] historicoDeTamanho;
+    }
+
+    void enfileira(int paciente, Tempo tempoAtual) {
+        No* novoNo = new No(paciente, tempoAtual);
+        if(inicio == nullptr) {
+            inicio = fim = novoNo;
+        } else {
+            fim->proximo = novoNo;
+            fim = novoNo;
+        }
+        tamanho++;
+        registraTamanho();
+    }
+
+    int desenfileira(Tempo tempoAtual) {
+        if(inicio == nullptr) return -1;
+
+        No* temp = inicio;
+        int paciente = temp->paciente;
+        inicio = inicio->proximo;
+        if(inicio == nullptr) fim = nullptr;
+
+        tempoTotalEspera += (tempoAtual - temp->tempoEntradaFila);
+        pacientesAtendidos++;
+        tamanho--;
+
+        delete temp;
+        registraTamanho();
+        return paciente;
+    }
+};
+
+static const long long OPERACOES = 4000000;
+static const int REPETICOES = 3;
+
+// Enche até profundidade, faz os ciclos e esvazia; devolve ns por operação.
+// soma acumula os índices retirados, para o compilador não descartar nada.
+template <typename F>
+double mede(F& fila, int profundidade, long long& soma) {
+    std::chrono::steady_clock::time_point inicio = std::chrono::steady_clock::now();
+    Tempo tempo = 0;
+    for(int i = 0; i < profundidade; i++) {
+        fila.enfileira(i, tempo++);
+    }
+    for(long long i = 0; i < OPERACOES; i++) {
+        int paciente = fila.desenfileira(tempo);
+        soma += paciente;
+        fila.enfileira(paciente, tempo++);
+    }
+    for(int i = 0; i < profundidade; i++) {
+        soma += fila.desenfileira(tempo++);
+    }
+    double segundos = std::chrono::duration<double>(std::chrono::steady_clock::now() - inicio).count();
+    return segundos * 1e9 / (2.0 * profundidade + 2.0 * OPERACOES);
+}
+
+int main() {
+    static const int profundidades[] = {1000, 10000, 100000, 1000000};
+
+    // Pacientes para a Fila, que registra a pertença no cadastro
+    CadastroPacientes pacientes(false);
+    Prontuario prontuario = {};
+    for(int i = 0; i < profundidades[3]; i++) {
+        prontuario.id = i;
+        pacientes.adiciona(prontuario);
+    }
+
+    long long soma = 0;
+    std::printf("%12s %14s %14s %10s\n", "profundidade", "lista (ns/op)", "anel (ns/op)", "razão");
+    for(int profundidade : profundidades) {
+        double melhorLista = 0;
+        double melhorAnel = 0;
+        for(int r = 0; r < REPETICOES; r++) {
+            FilaLista lista;
+            double ns = mede(lista, profundidade, soma);
+            if(r == 0 || ns < melhorLista) melhorLista = ns;
+
+            Fila anel(pacientes, 0, PROC_MEDIDAS);
+            ns = mede(anel, profundidade, soma);
+            if(r == 0 || ns < melhorAnel) melhorAnel = ns;
+        }
+        std::printf("%12d %14.2f %14.2f %9.2fx\n", profundidade, melhorLista, melhorAnel,
+                    melhorLista / melhorAnel);
+    }
+    std::fprintf(stderr, "(soma de controle %lld)\n", soma);
+    return 0;
+}
\ No newline at end of file
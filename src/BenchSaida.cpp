@@ -0,0 +1,103 @@
+// Benchmark da saída assíncrona (--saida=assincrona) contra a escrita direta
+// por std::ostream (--saida=direta), em volumes de 10^4 a 10^7 linhas. É um
+// programa à parte, compilado como o simulador:
+//   g++ -std=c++17 -O2 -pthread -o bench_saida src/BenchSaida.cpp
+//   ./bench_saida [arquivo]
+// As linhas imitam o log de rastreio e cada uma vem depois de um pouco de
+// cálculo, no papel da simulação que a thread escritora pode sobrepor à
+// gravação. O arquivo (bench_saida.txt por omissão) é truncado a cada rodada;
+// apontá-lo para um disco lento ou um pipe mostra o caso que a saída
+// assíncrona atende. O tempo é o de relógio até a saída ser fechada, o melhor
+// de REPETICOES rodadas. Com um só núcleo a escritora disputa a CPU com a
+// simulação e não há sobreposição; o que sobra é a diferença entre os
+// buffers de cada lado.
+
+#include <chrono>
+#include <cstdio>
+#include <fcntl.h>
+#include <fstream>
+#include <iostream>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include "Saida.cpp"
+
+static const int REPETICOES = 3;
+static const int TRABALHO_POR_LINHA = 200;
+
+// Formata linhas em saida, com o cálculo entre elas; devolve o acumulado
+// para o compilador não descartar o cálculo
+static unsigned long long escreveLinhas(std::ostream& saida, long long linhas) {
+    unsigned long long acumulado = 88172645463325252ULL;
+    for (long long i = 0; i < linhas; i++) {
+        for (int k = 0; k < TRABALHO_POR_LINHA; k++) {
+            acumulado ^= acumulado << 13;
+            acumulado ^= acumulado >> 7;
+            acumulado ^= acumulado << 17;
+        }
+        saida << "[TRACE] " << (1700000000 + i / 4) << " paciente " << (i % 100003)
+              << " INICIO_PROCEDIMENTO proc " << (i % 6) << " unidade " << (acumulado % 40)
+              << " fila " << (i % 257) << '\n';
+    }
+    return acumulado;
+}
+
+// Uma rodada com std::ofstream, como o std::cout da saída direta
+static double medeDireta(const char* caminho, long long linhas, unsigned long long& controle) {
+    std::chrono::steady_clock::time_point inicio = std::chrono::steady_clock::now();
+    std::ofstream saida(caminho, std::ios::trunc);
+    controle += escreveLinhas(saida, linhas);
+    saida.close();
+    if (saida.fail()) {
+        throw std::runtime_error(std::string("falha ao gravar ") + caminho);
+    }
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - inicio).count();
+}
+
+// Uma rodada com BufferAssincrono, contando a espera pela escritora no fim
+static double medeAssincrona(const char* caminho, long long linhas, unsigned long long& controle) {
+    std::chrono::steady_clock::time_point inicio = std::chrono::steady_clock::now();
+    int fd = open(caminho, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        throw std::runtime_error(std::string("não foi possível abrir ") + caminho);
+    }
+    BufferAssincrono buffer(fd);
+    std::ostream saida(&buffer);
+    controle += escreveLinhas(saida, linhas);
+    bool gravou = buffer.fecha();
+    close(fd);
+    if (!gravou) {
+        throw std::runtime_error(std::string("falha ao gravar ") + caminho);
+    }
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - inicio).count();
+}
+
+int main(int argc, char* argv[]) {
+    static const long long volumes[] = {10000, 100000, 1000000, 10000000};
+    const char* caminho = argc > 1 ? argv[1] : "bench_saida.txt";
+
+    try {
+        unsigned long long controle = 0;
+        std::printf("núcleos: %u\n", std::thread::hardware_concurrency());
+        std::printf("%10s %12s %15s %10s\n", "linhas", "direta (s)", "assíncrona (s)", "razão");
+        for (long long linhas : volumes) {
+            double melhorDireta = 0;
+            double melhorAssincrona = 0;
+            for (int r = 0; r < REPETICOES; r++) {
+                double segundos = medeDireta(caminho, linhas, controle);
+                if (r == 0 || segundos < melhorDireta) melhorDireta = segundos;
+
+                segundos = medeAssincrona(caminho, linhas, controle);
+                if (r == 0 || segundos < melhorAssincrona) melhorAssincrona = segundos;
+            }
+            std::printf("%10lld %12.3f %15.3f %9.2fx\n", linhas, melhorDireta, melhorAssincrona,
+                        melhorDireta / melhorAssincrona);
+        }
+        std::fprintf(stderr, "(controle %llu)\n", controle);
+    } catch (const std::exception& e) {
+        std::cerr << "Erro: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,173 @@
+#pragma once
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "Tipos.cpp"
+
+// Formato binário da entrada, para ser mapeado em memória sem análise:
+// um CabecalhoBinario seguido de numPacientes RegistroBinario, na ordem
+// do arquivo de texto. Os campos têm largura fixa e a ordem de bytes da
+// máquina que gravou (conferida por marcaOrdem). O cabeçalho guarda o
+// tamanho e a data de modificação do texto de origem, para saber se uma
+// cópia em cache ainda vale.
+static const char ASSINATURA_BINARIO[8] = {'H', 'O', 'S', 'P', 'B', 'I', 'N', '\0'};
+static const uint32_t VERSAO_BINARIO = 1;
+static const uint32_t MARCA_ORDEM_BINARIO = 0x01020304;
+
+struct CabecalhoBinario {
+    char assinatura[8];
+    uint32_t versao;
+    uint32_t marcaOrdem;
+    uint64_t numPacientes;
+    uint64_t tamanhoOrigem;        // Tamanho do texto de origem, em bytes
+    int64_t modificacaoOrigem;     // Modificação do texto de origem, em ns desde a época
+    double tempos[TOTAL_PROCEDIMENTOS];     // Horas, por ProcedimentoId
+    int32_t unidades[TOTAL_PROCEDIMENTOS];
+    uint8_t reservado[16];
+};
+
+struct RegistroBinario {
+    int64_t tempoAdmissao;         // Ticks, como Paciente::getTempoAdmissao
+    int32_t id;
+    int32_t ano;
+    int16_t mes;                   // Como no texto, sem normalizar (dia 40 de janeiro vale)
+    int16_t dia;
+    int16_t hora;
+    int16_t grau;
+    int16_t alta;
+    int16_t reservado[3];
+    int32_t medidas;
+    int32_t testes;
+    int32_t imagem;
+    int32_t instrumentos;
+};
+
+static_assert(sizeof(CabecalhoBinario) == 128, "layout do cabeçalho binário mudou");
+static_assert(sizeof(RegistroBinario) == 48, "layout do registro binário mudou");
+
+inline int64_t modificacaoEmNs(const struct stat& info) {
+    return (int64_t)info.st_mtim.tv_sec * 1000000000 + info.st_mtim.tv_nsec;
+}
+
+// Confere assinatura, versão e ordem de bytes; false com a mensagem em erro
+inline bool cabecalhoBinarioValido(const CabecalhoBinario& cabecalho, std::string& erro) {
+    if (std::memcmp(cabecalho.assinatura, ASSINATURA_BINARIO, sizeof(ASSINATURA_BINARIO)) != 0) {
+        erro = "assinatura binária ausente";
+        return false;
+    }
+    if (cabecalho.marcaOrdem != MARCA_ORDEM_BINARIO) {
+        erro = "arquivo binário gravado com outra ordem de bytes";
+        return false;
+    }
+    if (cabecalho.versao != VERSAO_BINARIO) {
+        erro = "versão " + std::to_string(cabecalho.versao) + " do formato binário não suportada";
+        return false;
+    }
+    return true;
+}
+
+// Verifica se o binário em nomeCache foi gerado a partir da versão atual de
+// nomeOrigem
+inline bool binarioAtualizado(const std::string& nomeOrigem, const std::string& nomeCache) {
+    struct stat origem;
+    if (stat(nomeOrigem.c_str(), &origem) != 0) {
+        return false;
+    }
+
+    int fd = open(nomeCache.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    CabecalhoBinario cabecalho;
+    bool lido = pread(fd, &cabecalho, sizeof(cabecalho), 0) == (ssize_t)sizeof(cabecalho);
+    close(fd);
+
+    std::string erro;
+    return lido && cabecalhoBinarioValido(cabecalho, erro) &&
+           cabecalho.tamanhoOrigem == (uint64_t)origem.st_size &&
+           cabecalho.modificacaoOrigem == modificacaoEmNs(origem);
+}
+
+// Grava o binário em um arquivo temporário de nome único ao lado do destino
+// e o renomeia no fim, para que um leitor nunca veja um arquivo pela metade.
+// Execuções simultâneas gravam cada uma no seu temporário; a última a
+// renomear vence, com um arquivo completo.
+class GravadorBinario {
+private:
+    std::string destino;
+    std::string temporario;
+    int fd;
+    char* buffer;
+    std::size_t usado;
+    bool falhou;
+
+    static const std::size_t TAMANHO_BUFFER = 1 << 20;
+
+    void grava(const void* dados, std::size_t tamanho) {
+        if (falhou) return;
+        if (usado + tamanho > TAMANHO_BUFFER) {
+            descarrega();
+        }
+        std::memcpy(buffer + usado, dados, tamanho);
+        usado += tamanho;
+    }
+
+    void descarrega() {
+        const char* p = buffer;
+        while (usado > 0 && !falhou) {
+            ssize_t escrito = ::write(fd, p, usado);
+            if (escrito < 0) {
+                if (errno == EINTR) continue;
+                falhou = true;
+                break;
+            }
+            p += escrito;
+            usado -= escrito;
+        }
+        usado = 0;
+    }
+
+public:
+    GravadorBinario(const std::string& _destino)
+        : destino(_destino), temporario(_destino + ".XXXXXX"), fd(-1), usado(0), falhou(false) {
+        buffer = new char[TAMANHO_BUFFER];
+        fd = mkstemp(&temporario[0]);
+        if (fd < 0) {
+            temporario.clear();   // Nada a remover
+        }
+        falhou = fd < 0 || fchmod(fd, 0644) != 0;
+    }
+
+    ~GravadorBinario() {
+        if (fd >= 0) {
+            close(fd);
+            unlink(temporario.c_str());
+        }
+        delete[] buffer;
+    }
+
+    void gravaCabecalho(const CabecalhoBinario& cabecalho) {
+        grava(&cabecalho, sizeof(cabecalho));
+    }
+
+    void gravaRegistro(const RegistroBinario& registro) {
+        grava(&registro, sizeof(registro));
+    }
+
+    // Fecha e publica o arquivo; false se algo falhou
+    bool conclui() {
+        descarrega();
+        if (fd >= 0 && close(fd) != 0) falhou = true;
+        fd = -1;
+        if (!falhou && rename(temporario.c_str(), destino.c_str()) != 0) falhou = true;
+        if (falhou && !temporario.empty()) unlink(temporario.c_str());
+        return !falhou;
+    }
+};
\ No newline at end of file
@@ -0,0 +1,552 @@
+#pragma once
+
+#include <algorithm>
+#include "Evento.cpp"
+
+// Conjuntos de eventos pendentes usados pelo Escalonador. Todos guardam
+// apenas posições do EventoPool e comparam os eventos pelo próprio pool.
+
+// Min-heap binário: O(log n) por inserção e remoção
+class HeapEventos {
+private:
+    const EventoPool& pool;
+    int* heap;
+    int capacidade;
+    int tamanho_;
+
+    bool maior(int a, int b) const {
+        return pool[heap[a]] > pool[heap[b]];
+    }
+
+    void troca(int a, int b) {
+        int temp = heap[a];
+        heap[a] = heap[b];
+        heap[b] = temp;
+    }
+
+    void subir(int i) {
+        while (i > 0) {
+            int pai = (i - 1) / 2;
+            if (maior(pai, i)) {
+                troca(pai, i);
+                i = pai;
+            } else {
+                break;
+            }
+        }
+    }
+
+    void descer(int i) {
+        int menor;
+        int esq = 2 * i + 1;
+        int dir = 2 * i + 2;
+        int n = tamanho_;
+
+        while (esq < n) {
+            if (dir < n && maior(esq, dir)) {
+                menor = dir;
+            } else {
+                menor = esq;
+            }
+
+            if (maior(i, menor)) {
+                troca(i, menor);
+                i = menor;
+                esq = 2 * i + 1;
+                dir = 2 * i + 2;
+            } else {
+                break;
+            }
+        }
+    }
+
+public:
+    HeapEventos(const EventoPool& _pool, int capacidadeInicial = 1000)
+        : pool(_pool), capacidade(capacidadeInicial), tamanho_(0) {
+        heap = new int[capacidade];
+    }
+
+    ~HeapEventos() {
+        delete[] heap;
+    }
+
+    void insere(int posicao) {
+        acrescenta(posicao);
+        subir(tamanho_ - 1);
+    }
+
+    // Anexa sem restaurar a ordem do heap; reconstroi() precisa ser chamado
+    // antes da próxima consulta
+    void acrescenta(int posicao) {
+        if (tamanho_ == capacidade) {
+            int novaCapacidade = capacidade * 2;
+            int* novoHeap = new int[novaCapacidade];
+            for (int i = 0; i < tamanho_; i++) {
+                novoHeap[i] = heap[i];
+            }
+            delete[] heap;
+            heap = novoHeap;
+            capacidade = novaCapacidade;
+        }
+
+        heap[tamanho_] = posicao;
+        tamanho_++;
+    }
+
+    // Monta o heap de baixo para cima (Floyd), em O(n)
+    void reconstroi() {
+        for (int i = tamanho_ / 2 - 1; i >= 0; i--) {
+            descer(i);
+        }
+    }
+
+    int topo() const {
+        return heap[0];
+    }
+
+    int retira() {
+        int posicao = heap[0];
+        tamanho_--;
+        if (tamanho_ > 0) {
+            heap[0] = heap[tamanho_];
+            descer(0);
+        }
+        return posicao;
+    }
+
+    void clear() { tamanho_ = 0; }
+    bool vazio() const { return tamanho_ == 0; }
+    int tamanho() const { return tamanho_; }
+};
+
+// Fila de calendário (Brown, 1988): os eventos são espalhados em baldes
+// de largura fixa, como os dias de um ano, e cada balde é uma lista
+// ordenada. Com a largura bem ajustada inserção e remoção são O(1)
+// amortizado. O número de baldes dobra ou cai pela metade conforme o
+// tamanho, e a largura é recalculada a partir dos intervalos observados
+// entre os eventos mais próximos a cada redimensionamento.
+class CalendarioEventos {
+private:
+    static const int MIN_BALDES = 16;
+    static const int AMOSTRA_LARGURA = 25;
+
+    const EventoPool& pool;
+    int* baldes;          // Primeira posição de cada balde (-1 se vazio)
+    int* caudas;          // Última posição de cada balde, para anexar em O(1)
+    int numBaldes;        // Sempre potência de 2
+    Tempo largura;        // Largura de cada balde em ticks
+    int* proximo;         // Encadeamento das listas, indexado pela posição no pool
+    int capacidadeProximo;
+    int tamanho_;
+    Tempo ultimoTempo;    // Tempo do último evento retirado
+    long long diaAtual;   // Dia (intervalo de largura) em que a busca continua
+
+    long long dia(int posicao) const {
+        return pool[posicao].getTempoRelativo() / largura;
+    }
+
+    int balde(long long d) const {
+        return (int)(d & (numBaldes - 1));
+    }
+
+    void garanteProximo(int posicao) {
+        if (posicao < capacidadeProximo) return;
+
+        int novaCapacidade = capacidadeProximo * 2;
+        while (novaCapacidade <= posicao) novaCapacidade *= 2;
+        int* novo = new int[novaCapacidade];
+        for (int i = 0; i < capacidadeProximo; i++) {
+            novo[i] = proximo[i];
+        }
+        delete[] proximo;
+        proximo = novo;
+        capacidadeProximo = novaCapacidade;
+    }
+
+    // Insere na lista do balde mantendo a ordem; empates ficam na ordem de chegada
+    void insereNoBalde(int posicao) {
+        int b = balde(dia(posicao));
+        const Evento& evento = pool[posicao];
+
+        if (baldes[b] == -1) {
+            proximo[posicao] = -1;
+            baldes[b] = caudas[b] = posicao;
+            return;
+        }
+        if (!(pool[caudas[b]] > evento)) {
+            proximo[posicao] = -1;
+            proximo[caudas[b]] = posicao;
+            caudas[b] = posicao;
+            return;
+        }
+        if (pool[baldes[b]] > evento) {
+            proximo[posicao] = baldes[b];
+            baldes[b] = posicao;
+            return;
+        }
+
+        int atual = baldes[b];
+        while (proximo[atual] != -1 && !(pool[proximo[atual]] > evento)) {
+            atual = proximo[atual];
+        }
+        proximo[posicao] = proximo[atual];
+        proximo[atual] = posicao;
+    }
+
+    // Estima a largura com os menores eventos pendentes: média dos intervalos,
+    // descartando os maiores que o dobro da média, multiplicada por 3
+    Tempo estimaLargura(const int* posicoes, int n) const {
+        int k = n < AMOSTRA_LARGURA ? n : AMOSTRA_LARGURA;
+        if (k < 2) return largura;
+
+        // Seleção parcial dos k menores tempos, sem alterar a ordem original
+        int* amostra = new int[n];
+        for (int i = 0; i < n; i++) {
+            amostra[i] = posicoes[i];
+        }
+        for (int i = 0; i < k; i++) {
+            int menor = i;
+            for (int j = i + 1; j < n; j++) {
+                if (pool[amostra[menor]] > pool[amostra[j]]) menor = j;
+            }
+            int temp = amostra[i];
+            amostra[i] = amostra[menor];
+            amostra[menor] = temp;
+        }
+
+        double soma = (double)(pool[amostra[k - 1]].getTempoRelativo() - pool[amostra[0]].getTempoRelativo());
+        double media = soma / (k - 1);
+
+        double somaFiltrada = 0;
+        int contagem = 0;
+        for (int i = 1; i < k && media > 0; i++) {
+            double intervalo = (double)(pool[amostra[i]].getTempoRelativo() - pool[amostra[i - 1]].getTempoRelativo());
+            if (intervalo <= 2 * media) {
+                somaFiltrada += intervalo;
+                contagem++;
+            }
+        }
+        delete[] amostra;
+
+        if (media <= 0) return largura;
+        double novaLargura = contagem > 0 ? 3 * somaFiltrada / contagem : 3 * media;
+        return novaLargura >= 1 ? (Tempo)(novaLargura + 0.5) : 1;
+    }
+
+    void redimensiona(int novoNumBaldes) {
+        int* posicoes = new int[tamanho_ > 0 ? tamanho_ : 1];
+        int n = 0;
+        for (int b = 0; b < numBaldes; b++) {
+            for (int p = baldes[b]; p != -1; p = proximo[p]) {
+                posicoes[n++] = p;
+            }
+        }
+
+        largura = estimaLargura(posicoes, n);
+
+        delete[] baldes;
+        delete[] caudas;
+        numBaldes = novoNumBaldes;
+        baldes = new int[numBaldes];
+        caudas = new int[numBaldes];
+        for (int b = 0; b < numBaldes; b++) {
+            baldes[b] = -1;
+        }
+
+        for (int i = 0; i < n; i++) {
+            insereNoBalde(posicoes[i]);
+        }
+        diaAtual = ultimoTempo / largura;
+        for (int i = 0; i < n; i++) {
+            long long d = dia(posicoes[i]);
+            if (d < diaAtual) diaAtual = d;
+        }
+
+        delete[] posicoes;
+    }
+
+public:
+    CalendarioEventos(const EventoPool& _pool, Tempo larguraInicial = TICKS_POR_HORA)
+        : pool(_pool), numBaldes(MIN_BALDES), largura(larguraInicial),
+          capacidadeProximo(1000), tamanho_(0), ultimoTempo(0), diaAtual(0) {
+        baldes = new int[numBaldes];
+        caudas = new int[numBaldes];
+        for (int b = 0; b < numBaldes; b++) {
+            baldes[b] = -1;
+        }
+        proximo = new int[capacidadeProximo];
+    }
+
+    ~CalendarioEventos() {
+        delete[] baldes;
+        delete[] caudas;
+        delete[] proximo;
+    }
+
+    void insere(int posicao) {
+        garanteProximo(posicao);
+
+        long long d = dia(posicao);
+        if (tamanho_ == 0 || d < diaAtual) {
+            diaAtual = d;
+            ultimoTempo = pool[posicao].getTempoRelativo();
+        }
+
+        insereNoBalde(posicao);
+        tamanho_++;
+
+        if (tamanho_ > 2 * numBaldes) {
+            redimensiona(numBaldes * 2);
+        }
+    }
+
+    int topo() {
+        return baldes[localizaMenor()];
+    }
+
+    int retira() {
+        return removeCabeca(localizaMenor());
+    }
+
+    void clear() {
+        for (int b = 0; b < numBaldes; b++) {
+            baldes[b] = -1;
+        }
+        tamanho_ = 0;
+        ultimoTempo = 0;
+        diaAtual = 0;
+    }
+
+    bool vazio() const { return tamanho_ == 0; }
+    int tamanho() const { return tamanho_; }
+
+private:
+    // Retorna o balde cuja cabeça é o menor evento, deixando diaAtual no dia dele
+    int localizaMenor() {
+        // Procura no ano corrente a partir do dia do último evento retirado
+        for (int i = 0; i < numBaldes; i++) {
+            int b = balde(diaAtual);
+            int cabeca = baldes[b];
+            if (cabeca != -1 && dia(cabeca) <= diaAtual) {
+                return b;
+            }
+            diaAtual++;
+        }
+
+        // Nenhum evento no próximo ano: busca direta pelo menor entre as cabeças
+        int melhor = -1;
+        for (int b = 0; b < numBaldes; b++) {
+            if (baldes[b] != -1 && (melhor == -1 || pool[baldes[melhor]] > pool[baldes[b]])) {
+                melhor = b;
+            }
+        }
+        diaAtual = dia(baldes[melhor]);
+        return melhor;
+    }
+
+    int removeCabeca(int b) {
+        int posicao = baldes[b];
+        baldes[b] = proximo[posicao];
+        tamanho_--;
+        ultimoTempo = pool[posicao].getTempoRelativo();
+
+        if (tamanho_ < numBaldes / 2 && numBaldes > MIN_BALDES) {
+            redimensiona(numBaldes / 2);
+        }
+        return posicao;
+    }
+};
+
+
+// Raia FIFO de eventos que chegam em ordem não decrescente de tempo.
+// Enquanto ninguém retirou eventos dela, aceita inserções fora de ordem e
+// se ordena uma única vez na primeira consulta (caso das chegadas lidas do
+// arquivo). Depois disso só aceita eventos em ordem.
+class RaiaEventos {
+private:
+    const EventoPool& pool;
+    int* data;
+    int capacidade;
+    int inicio;
+    int fim;
+    bool ordenada;
+    bool consumida;   // Já houve retirada desde a última ordenação
+
+    void garanteEspaco() {
+        if (fim < capacidade) return;
+
+        // Reaproveita o espaço já consumido antes de crescer
+        if (inicio > capacidade / 2) {
+            for (int i = inicio; i < fim; i++) {
+                data[i - inicio] = data[i];
+            }
+            fim -= inicio;
+            inicio = 0;
+            return;
+        }
+
+        int novaCapacidade = capacidade * 2;
+        int* novo = new int[novaCapacidade];
+        for (int i = inicio; i < fim; i++) {
+            novo[i - inicio] = data[i];
+        }
+        delete[] data;
+        data = novo;
+        fim -= inicio;
+        inicio = 0;
+        capacidade = novaCapacidade;
+    }
+
+    void ordena() {
+        const EventoPool& p = pool;
+        std::stable_sort(data + inicio, data + fim, [&p](int a, int b) {
+            return p[b] > p[a];
+        });
+        ordenada = true;
+    }
+
+public:
+    RaiaEventos(const EventoPool& _pool, int capacidadeInicial = 64)
+        : pool(_pool), capacidade(capacidadeInicial), inicio(0), fim(0),
+          ordenada(true), consumida(false) {
+        data = new int[capacidade];
+    }
+
+    ~RaiaEventos() {
+        delete[] data;
+    }
+
+    // Tenta anexar o evento; retorna false se isso quebraria a ordem da raia
+    bool insere(int posicao) {
+        if (fim > inicio && pool[data[fim - 1]] > pool[posicao]) {
+            if (consumida) return false;
+            ordenada = false;
+        }
+
+        garanteEspaco();
+        data[fim++] = posicao;
+        return true;
+    }
+
+    int topo() {
+        if (!ordenada) ordena();
+        return data[inicio];
+    }
+
+    int retira() {
+        if (!ordenada) ordena();
+        consumida = true;
+        int posicao = data[inicio++];
+        if (inicio == fim) {
+            inicio = fim = 0;
+            consumida = false;
+        }
+        return posicao;
+    }
+
+    void clear() {
+        inicio = fim = 0;
+        ordenada = true;
+        consumida = false;
+    }
+
+    bool vazio() const { return inicio == fim; }
+    int tamanho() const { return fim - inicio; }
+};
+
+// Conjunto de eventos em raias monotônicas. Como o tempo de cada
+// procedimento é constante, os FIM_PROCEDIMENTO de um mesmo procedimento
+// são gerados em ordem de tempo e cabem numa FIFO por procedimento; as
+// chegadas ficam numa raia ordenada. Os INICIO_PROCEDIMENTO são agendados no
+// tempo atual e vão para a raia imediata do Escalonador, sem chegar aqui. O
+// próximo evento é o menor entre as cabeças das raias. O que não tiver raia
+// ou não respeitar a ordem da sua vai para um heap de reserva.
+class RaiasEventos {
+private:
+    static const int RAIA_CHEGADAS = 0;
+    static const int RAIA_FIM = 1;   // Primeira raia de FIM_PROCEDIMENTO
+    static const int NUM_RAIAS = RAIA_FIM + TOTAL_PROCEDIMENTOS;
+
+    const EventoPool& pool;
+    RaiaEventos* raias[NUM_RAIAS];
+    HeapEventos reserva;
+    int tamanho_;
+
+    int raiaDoEvento(const Evento& evento) const {
+        switch (evento.getTipo()) {
+            case Evento::CHEGADA_PACIENTE:
+                return RAIA_CHEGADAS;
+            case Evento::FIM_PROCEDIMENTO:
+                if (evento.getProcedimento() >= 0 && evento.getProcedimento() < TOTAL_PROCEDIMENTOS) {
+                    return RAIA_FIM + evento.getProcedimento();
+                }
+                return -1;
+            default:
+                return -1;
+        }
+    }
+
+    // Raia com o menor evento, ou -1 se for o heap de reserva. Os eventos têm
+    // chaves distintas, então não há empates.
+    int localizaMenor() {
+        int melhorRaia = -1;
+        int melhor = -1;
+        for (int i = 0; i < NUM_RAIAS; i++) {
+            if (raias[i]->vazio()) continue;
+            int cabeca = raias[i]->topo();
+            if (melhor == -1 || pool[melhor] > pool[cabeca]) {
+                melhor = cabeca;
+                melhorRaia = i;
+            }
+        }
+
+        if (!reserva.vazio() && (melhor == -1 || pool[melhor] > pool[reserva.topo()])) {
+            return -1;
+        }
+        return melhorRaia;
+    }
+
+public:
+    RaiasEventos(const EventoPool& _pool)
+        : pool(_pool), reserva(_pool, 64), tamanho_(0) {
+        for (int i = 0; i < NUM_RAIAS; i++) {
+            raias[i] = new RaiaEventos(pool);
+        }
+    }
+
+    ~RaiasEventos() {
+        for (int i = 0; i < NUM_RAIAS; i++) {
+            delete raias[i];
+        }
+    }
+
+    void insere(int posicao) {
+        int raia = raiaDoEvento(pool[posicao]);
+        if (raia < 0 || !raias[raia]->insere(posicao)) {
+            reserva.insere(posicao);
+        }
+        tamanho_++;
+    }
+
+    int topo() {
+        int raia = localizaMenor();
+        return raia < 0 ? reserva.topo() : raias[raia]->topo();
+    }
+
+    int retira() {
+        int raia = localizaMenor();
+        tamanho_--;
+        return raia < 0 ? reserva.retira() : raias[raia]->retira();
+    }
+
+    void clear() {
+        for (int i = 0; i < NUM_RAIAS; i++) {
+            raias[i]->clear();
+        }
+        reserva.clear();
+        tamanho_ = 0;
+    }
+
+    bool vazio() const { return tamanho_ == 0; }
+    int tamanho() const { return tamanho_; }
+};
\ No newline at end of file
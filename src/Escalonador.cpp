@@ -1,223 +1,250 @@
 #include <iostream>
+#include <stdexcept>
+#include "Log.cpp"
 #include "Fila.cpp"
+#include "ConjuntoEventos.cpp"
 
-class Evento {
-private:
-    double dataHora;
-    int tipo;
-    Paciente* paciente;
-    std::string procedimento;
-
+class Escalonador {
 public:
-    Evento(double _dataHora, int tipo, Paciente* _paciente, const std::string& _procedimento = "") 
-        : dataHora(_dataHora), tipo(tipo), paciente(_paciente), procedimento(_procedimento) {}
-
-    double getDataHora() const { return dataHora; }
-    int getTipo() const { return tipo; }
-    Paciente* getPaciente() const { return paciente; }
-    std::string getProcedimento() const { return procedimento; }
-
-    bool operator>(const Evento& outro) const {
-        return dataHora > outro.dataHora;
-    }
-};
+    // Estrutura usada para guardar os eventos pendentes
+    enum TipoConjunto {
+        CONJUNTO_HEAP = 1,
+        CONJUNTO_CALENDARIO = 2,
+        CONJUNTO_RAIAS = 3
+    };
 
-class EventoArray {           
 private:
-    Evento** data;
-    int capacity;
-    int size_;
-
-public:
-    EventoArray(int initialCapacity = 1000) : capacity(initialCapacity), size_(0) {
-        data = new Evento*[capacity];
-    }
-
-    ~EventoArray() {
-        for (int i = 0; i < size_; i++) {
-            delete data[i];
+    EventoPool pool;
+    int tipoConjunto;
+    HeapEventos heap;
+    CalendarioEventos calendario;
+    RaiasEventos raias;
+    RaiaEventos imediatos;   // Eventos agendados para o próprio tempo atual
+    Tempo tempoInicial;           // Origem dos tempos relativos nas chaves dos eventos
+    Tempo tempoAtual;
+    unsigned long long proximaSequencia;   // Desempate estável entre eventos simultâneos
+    int eventosProcessados;
+    long long insercoes;          // Operações no conjunto de eventos, para comparação
+    long long remocoes;
+    long long eventosImediatos;   // Eventos que passaram só pela raia imediata
+    int maiorTamanho;             // Maior número de eventos pendentes no conjunto
+
+    void insereConjunto(int posicao) {
+        switch (tipoConjunto) {
+            case CONJUNTO_CALENDARIO:
+                calendario.insere(posicao);
+                break;
+            case CONJUNTO_RAIAS:
+                raias.insere(posicao);
+                break;
+            default:
+                heap.insere(posicao);
+                break;
         }
-        delete[] data;
-    }
-
-    void push_back(const Evento& elemento) {
-        if (size_ == capacity) {
-            int newCapacity = capacity * 2;
-            Evento** newData = new Evento*[newCapacity];
-            
-            for (int i = 0; i < size_; i++) {
-                newData[i] = data[i];
-            }
-            
-            delete[] data;
-            data = newData;
-            capacity = newCapacity;
+        if (tamanhoConjunto() > maiorTamanho) {
+            maiorTamanho = tamanhoConjunto();
         }
-        
-        data[size_] = new Evento(elemento);
-        size_++;
     }
 
-    Evento& operator[](int index) {
-        if (index < 0 || index >= size_) {
-            throw std::out_of_range("Index out of bounds");
+    int topoConjunto() {
+        switch (tipoConjunto) {
+            case CONJUNTO_CALENDARIO:
+                return calendario.topo();
+            case CONJUNTO_RAIAS:
+                return raias.topo();
+            default:
+                return heap.topo();
         }
-        return *data[index];
     }
 
-    void pop_back() {
-        if (size_ > 0) {
-            delete data[size_ - 1];
-            size_--;
+    int retiraConjunto() {
+        switch (tipoConjunto) {
+            case CONJUNTO_CALENDARIO:
+                return calendario.retira();
+            case CONJUNTO_RAIAS:
+                return raias.retira();
+            default:
+                return heap.retira();
         }
     }
 
-    Evento& back() {
-        if (size_ == 0) {
-            throw std::out_of_range("Array is empty");
+    int tamanhoConjunto() const {
+        switch (tipoConjunto) {
+            case CONJUNTO_CALENDARIO:
+                return calendario.tamanho();
+            case CONJUNTO_RAIAS:
+                return raias.tamanho();
+            default:
+                return heap.tamanho();
         }
-        return *data[size_ - 1];
     }
 
-    void clear() {
-        for (int i = 0; i < size_; i++) {
-            delete data[i];
+    // Monta o evento com o tempo relativo a tempoInicial; falha se o tempo ou
+    // a sequência não couberem na chave
+    Evento criaEvento(Tempo dataHora, unsigned long long sequencia, int tipo, int paciente,
+                      int procedimento = PROC_NENHUM, int unidade = -1) const {
+        Tempo relativo = dataHora - tempoInicial;
+        if (relativo < 0 || relativo > Evento::MAXIMO_TEMPO_RELATIVO) {
+            throw std::overflow_error("evento a " + std::to_string(relativo) + " s do início da simulação,"
+                                      " fora da faixa da chave (0 a " +
+                                      std::to_string(Evento::MAXIMO_TEMPO_RELATIVO) + " s)");
         }
-        size_ = 0;
+        if (sequencia > Evento::MAXIMO_SEQUENCIA) {
+            throw std::overflow_error("números de sequência de eventos esgotados");
+        }
+        return Evento(relativo, sequencia, tipo, paciente, procedimento, unidade);
     }
 
-    bool empty() const {
-        return size_ == 0;
+    // A raia imediata está em ordem de chave; só vence se a sua cabeça for
+    // menor que a do conjunto, o que mantém a ordem global dos eventos
+    bool imediatoPrimeiro() {
+        if (imediatos.vazio()) return false;
+        if (tamanhoConjunto() == 0) return true;
+        return pool[topoConjunto()] > pool[imediatos.topo()];
     }
 
-    int size() const {
-        return size_;
+public:
+    Escalonador(Tempo _tempoInicial = 0, int _tipoConjunto = CONJUNTO_HEAP) 
+        : tipoConjunto(_tipoConjunto), heap(pool), calendario(pool), raias(pool),
+          imediatos(pool), tempoInicial(_tempoInicial), tempoAtual(_tempoInicial), proximaSequencia(0),
+          eventosProcessados(0), insercoes(0), remocoes(0), eventosImediatos(0), maiorTamanho(0) {
     }
 
-    Evento* get_pointer(int index) {
-        if (index < 0 || index >= size_) {
-            throw std::out_of_range("Index out of bounds");
+    // Define a origem dos tempos; só antes do primeiro evento, e nenhum
+    // evento pode ser agendado antes dela
+    void defineTempoInicial(Tempo _tempoInicial) {
+        if (tamanho() > 0 || eventosProcessados > 0) {
+            throw std::logic_error("tempo inicial definido depois do primeiro evento");
         }
-        return data[index];
-    }
-
-    void swap(int i, int j) {
-        Evento* temp = data[i];
-        data[i] = data[j];
-        data[j] = temp;
+        tempoInicial = _tempoInicial;
+        tempoAtual = _tempoInicial;
     }
 
-    void remove_at(int index) {
-        if (index < 0 || index >= size_) {
-            throw std::out_of_range("Index out of bounds");
+    void inicializa() {
+        LOG_DEBUG("Inicializando escalonador. Eventos antes: " << tamanho());
+        pool.clear();
+        heap.clear();
+        calendario.clear();
+        raias.clear();
+        imediatos.clear();
+        tempoAtual = tempoInicial;
+        proximaSequencia = 0;
+        eventosProcessados = 0;
+        insercoes = 0;
+        remocoes = 0;
+        eventosImediatos = 0;
+        maiorTamanho = 0;
+        LOG_DEBUG("Eventos depois de inicializar: " << tamanho());
+    }
+
+    void insereEvento(Tempo dataHora, int tipo, int paciente, int procedimento = PROC_NENHUM,
+                      int unidade = -1) {
+        int posicao = pool.aloca(criaEvento(dataHora, proximaSequencia++, tipo, paciente, procedimento, unidade));
+
+        // Durante a simulação, um evento no tempo atual tem chave maior que
+        // todos os já agendados para esse tempo: basta anexá-lo à raia imediata
+        if (eventosProcessados > 0 && dataHora == tempoAtual && imediatos.insere(posicao)) {
+            eventosImediatos++;
+            return;
         }
-        delete data[index];
-        data[index] = data[size_ - 1];
-        size_--;
-    }
 
-    void decrease_size() {
-        if (size_ > 0) {
-            size_--;
-        }
+        insereConjunto(posicao);
+        insercoes++;
     }
-};
 
-class Escalonador {
-private:
-    EventoArray eventos;
-    double tempoInicial;
-    double tempoAtual;
-    int eventosProcessados;
-
-    void subir(int i) {
-        while (i > 0) {
-            int pai = (i - 1) / 2;
-            if (eventos[pai] > eventos[i]) {
-                std::swap(eventos[pai], eventos[i]);
-                i = pai;
-            } else {
-                break;
+    // Carga inicial em massa: no heap os eventos só são anexados e a ordem é
+    // montada de uma vez em concluiCarga, em O(n). O calendário e as raias já
+    // aceitam a inserção direta em O(1) amortizado.
+    void insereEventoEmCarga(Tempo dataHora, int tipo, int paciente) {
+        int posicao = pool.aloca(criaEvento(dataHora, proximaSequencia++, tipo, paciente));
+        if (tipoConjunto == CONJUNTO_HEAP) {
+            heap.acrescenta(posicao);
+            if (heap.tamanho() > maiorTamanho) {
+                maiorTamanho = heap.tamanho();
             }
+        } else {
+            insereConjunto(posicao);
         }
+        insercoes++;
     }
 
-    void descer(int i) {
-        int menor;
-        int esq = 2 * i + 1;
-        int dir = 2 * i + 2;
-        int n = eventos.size();
-
-        while (esq < n) {
-            if (dir < n && eventos[dir].getDataHora() < eventos[esq].getDataHora()) {
-                menor = dir;
-            } else {
-                menor = esq;
-            }
-
-            if (eventos[i] > eventos[menor]) {
-                std::swap(eventos[i], eventos[menor]);
-                i = menor;
-                esq = 2 * i + 1;
-                dir = 2 * i + 2;
-            } else {
-                break;
-            }
+    // Reserva n números de sequência para eventos agendados depois com
+    // insereEventoComSequencia e devolve o primeiro deles
+    unsigned long long reservaSequencias(int n) {
+        if (proximaSequencia + n > Evento::MAXIMO_SEQUENCIA + 1) {
+            throw std::overflow_error("números de sequência de eventos esgotados");
         }
+        unsigned long long primeira = proximaSequencia;
+        proximaSequencia += n;
+        return primeira;
     }
 
-public:
-    enum TipoEvento {
-        CHEGADA_PACIENTE = 1,
-        INICIO_PROCEDIMENTO = 2,
-        FIM_PROCEDIMENTO = 3,
-        ATUALIZACAO_SISTEMA = 4
-    };
-
-    Escalonador(double _tempoInicial = 0.0) 
-        : tempoInicial(_tempoInicial), tempoAtual(_tempoInicial), eventosProcessados(0) {
+    // Insere com uma sequência reservada. O evento vai sempre para o conjunto
+    // principal: a raia imediata só aceita sequências crescentes.
+    void insereEventoComSequencia(Tempo dataHora, unsigned long long sequencia, int tipo, int paciente) {
+        insereConjunto(pool.aloca(criaEvento(dataHora, sequencia, tipo, paciente)));
+        insercoes++;
     }
 
-    void inicializa() {
-        std::cout << "Inicializando escalonador. Eventos antes: " << eventos.size() << "\n";
-        eventos.clear();
-        tempoAtual = tempoInicial;
-        eventosProcessados = 0;
-        std::cout << "Eventos depois de inicializar: " << eventos.size() << "\n";
-    }
-
-    void insereEvento(double dataHora, int tipo, Paciente* paciente, const std::string& procedimento = "") {
-        eventos.push_back(Evento(dataHora, tipo, paciente, procedimento));
-        subir(eventos.size() - 1);
+    void concluiCarga() {
+        if (tipoConjunto == CONJUNTO_HEAP) {
+            heap.reconstroi();
+        }
     }
 
-    Evento* retiraProximoEvento() {
-        if (eventos.empty()) return nullptr;
-
-        Evento* proximo = eventos.get_pointer(0);
-        
-        if (eventos.size() > 1) {
-            eventos.swap(0, eventos.size() - 1);
+    // Remove o próximo evento e o devolve por valor; o seu tempo absoluto
+    // passa a ser getTempoAtual
+    Evento retiraProximoEvento() {
+        if (vazio()) {
+            throw std::out_of_range("Escalonador vazio");
         }
-        
-        eventos.decrease_size();
-        
-        if (!eventos.empty()) {
-            descer(0);
+
+        int posicao;
+        if (imediatoPrimeiro()) {
+            posicao = imediatos.retira();
+        } else {
+            posicao = retiraConjunto();
+            remocoes++;
         }
 
-        tempoAtual = proximo->getDataHora();
+        Evento proximo = pool[posicao];
+        pool.libera(posicao);
+
+        tempoAtual = tempoInicial + proximo.getTempoRelativo();
         eventosProcessados++;
         return proximo;
     }
 
-    void finaliza(int& totalEventos, double& tempoTotal) {
+    void finaliza(int& totalEventos, Tempo& tempoTotal) {
         totalEventos = eventosProcessados;
         tempoTotal = tempoAtual - tempoInicial;
-        eventos.clear();
+        pool.clear();
+        heap.clear();
+        calendario.clear();
+        raias.clear();
+        imediatos.clear();
     }
 
-    double getTempoAtual() const { return tempoAtual; }
-    bool vazio() const { return eventos.empty(); }
-    int tamanho() const { return eventos.size(); }
+    // Tempo do próximo evento, sem retirá-lo
+    Tempo getProximoTempo() {
+        if (vazio()) {
+            throw std::out_of_range("Escalonador vazio");
+        }
+
+        int posicao = imediatoPrimeiro() ? imediatos.topo() : topoConjunto();
+        return tempoInicial + pool[posicao].getTempoRelativo();
+    }
+
+    Tempo getTempoAtual() const { return tempoAtual; }
+    Tempo getTempoInicial() const { return tempoInicial; }
+    long long getInsercoes() const { return insercoes; }
+    long long getRemocoes() const { return remocoes; }
+    long long getEventosImediatos() const { return eventosImediatos; }
+    int getMaiorTamanho() const { return maiorTamanho; }
+    int getTipoConjunto() const { return tipoConjunto; }
+    bool vazio() const { return tamanho() == 0; }
+
+    int tamanho() const {
+        return tamanhoConjunto() + imediatos.tamanho();
+    }
 };
\ No newline at end of file
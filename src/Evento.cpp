@@ -0,0 +1,135 @@
+#pragma once
+
+#include "Tipos.cpp"
+
+// Registro de evento de tamanho fixo, guardado por valor no pool do escalonador.
+// A ordem é dada por uma chave de 64 bits que empacota o tempo relativo ao
+// início da simulação (32 bits altos, cerca de 136 anos em segundos) e um
+// número de sequência de inserção (32 bits baixos): eventos no mesmo instante
+// saem na ordem em que foram agendados, qualquer que seja o conjunto usado.
+// Quem monta a chave (o Escalonador) confere as duas faixas.
+class Evento {
+public:
+    static const int BITS_SEQUENCIA = 32;
+    static const unsigned long long MAXIMO_SEQUENCIA = (1ULL << BITS_SEQUENCIA) - 1;
+    static const Tempo MAXIMO_TEMPO_RELATIVO = (1LL << (64 - BITS_SEQUENCIA)) - 1;
+
+    enum TipoEvento {
+        CHEGADA_PACIENTE = 1,
+        INICIO_PROCEDIMENTO = 2,
+        FIM_PROCEDIMENTO = 3,
+        ATUALIZACAO_SISTEMA = 4
+    };
+
+private:
+    unsigned long long chave;   // (tempo relativo << BITS_SEQUENCIA) | sequência
+    int paciente;               // Índice do paciente em Hospital::pacientes
+    unsigned char tipo;
+    signed char procedimento;   // ProcedimentoId (PROC_NENHUM se não se aplica)
+    short unidade;              // Unidade ocupada, no INICIO e no FIM_PROCEDIMENTO; -1 nos demais
+
+public:
+    Evento() : chave(0), paciente(-1), tipo(0), procedimento(PROC_NENHUM), unidade(-1) {}
+
+    // O tempo relativo vai de 0 a MAXIMO_TEMPO_RELATIVO e a sequência até
+    // MAXIMO_SEQUENCIA; a unidade vai até MAX_UNIDADES - 1, que cabe num short
+    Evento(Tempo tempoRelativo, unsigned long long sequencia, int _tipo, int _paciente,
+           int _procedimento = PROC_NENHUM, int _unidade = -1) 
+        : chave(((unsigned long long)tempoRelativo << BITS_SEQUENCIA) | sequencia),
+          paciente(_paciente), tipo((unsigned char)_tipo), procedimento((signed char)_procedimento),
+          unidade((short)_unidade) {}
+
+    // Ticks desde Escalonador::getTempoInicial
+    Tempo getTempoRelativo() const { return (Tempo)(chave >> BITS_SEQUENCIA); }
+    unsigned long long getChave() const { return chave; }
+    int getTipo() const { return tipo; }
+    int getPaciente() const { return paciente; }
+    int getProcedimento() const { return procedimento; }
+    int getUnidade() const { return unidade; }
+
+    bool operator>(const Evento& outro) const {
+        return chave > outro.chave;
+    }
+};
+
+// Pool contíguo de eventos. As posições liberadas são reaproveitadas
+// por uma lista de livres, então não há alocação por evento.
+class EventoPool {
+private:
+    Evento* data;
+    int* livres;       // Pilha de posições livres
+    int capacity;
+    int size_;         // Posições já usadas alguma vez (marca d'água)
+    int numLivres;
+
+    void cresce() {
+        int newCapacity = capacity * 2;
+        Evento* newData = new Evento[newCapacity];
+        int* newLivres = new int[newCapacity];
+
+        for (int i = 0; i < size_; i++) {
+            newData[i] = data[i];
+        }
+        for (int i = 0; i < numLivres; i++) {
+            newLivres[i] = livres[i];
+        }
+
+        delete[] data;
+        delete[] livres;
+        data = newData;
+        livres = newLivres;
+        capacity = newCapacity;
+    }
+
+public:
+    EventoPool(int initialCapacity = 1000)
+        : capacity(initialCapacity), size_(0), numLivres(0) {
+        data = new Evento[capacity];
+        livres = new int[capacity];
+    }
+
+    ~EventoPool() {
+        delete[] data;
+        delete[] livres;
+    }
+
+    // Guarda o evento e retorna a posição ocupada
+    int aloca(const Evento& evento) {
+        int posicao;
+        if (numLivres > 0) {
+            posicao = livres[--numLivres];
+        } else {
+            if (size_ == capacity) {
+                cresce();
+            }
+            posicao = size_++;
+        }
+        data[posicao] = evento;
+        return posicao;
+    }
+
+    void libera(int posicao) {
+        livres[numLivres++] = posicao;
+    }
+
+    Evento& operator[](int posicao) {
+        return data[posicao];
+    }
+
+    const Evento& operator[](int posicao) const {
+        return data[posicao];
+    }
+
+    void clear() {
+        size_ = 0;
+        numLivres = 0;
+    }
+
+    int size() const {
+        return size_ - numLivres;
+    }
+
+    int capacidade() const {
+        return capacity;
+    }
+};
@@ -2,35 +2,169 @@
 #include "Procedimento.cpp"
 #include <string>
 
-class Fila {
-private:
+// Buffer circular contíguo de (índice do paciente, tempo de entrada) que cresce por
+// dobramento. As posições são reaproveitadas, então enfileirar e
+// desenfileirar não alocam memória depois que o balde atinge seu tamanho máximo.
+class BaldeFila {
+public:
     struct No {
-        Paciente* paciente;
-        double tempoEntradaFila;
-        No* proximo;
-
-        No(Paciente* p, double tempo) : paciente(p), tempoEntradaFila(tempo), proximo(nullptr) {}
+        int paciente;             // Índice no CadastroPacientes
+        uint32_t entrada;         // Número da entrada na fila, truncado (ver Fila::desenfileiraAte)
+        Tempo tempoEntradaFila;
     };
 
-    No* inicio;
-    No* fim;
+private:
+    No* nos;
+    int capacidade;               // Sempre potência de 2
+    int cabeca;                   // Posição do primeiro paciente
+    int tamanho;
+
+    // Posição no buffer do i-ésimo paciente do balde
+    int posicao(int i) const {
+        return (cabeca + i) & (capacidade - 1);
+    }
+
+    void cresce() {
+        int novaCapacidade = capacidade * 2;
+        No* novos = new No[novaCapacidade];
+        for(int i = 0; i < tamanho; i++) {
+            novos[i] = nos[posicao(i)];
+        }
+        delete[] nos;
+        nos = novos;
+        capacidade = novaCapacidade;
+        cabeca = 0;
+    }
+
+public:
+    BaldeFila() : capacidade(16), cabeca(0), tamanho(0) {
+        nos = new No[capacidade];
+    }
+
+    ~BaldeFila() {
+        delete[] nos;
+    }
+
+    void insere(int paciente, Tempo tempoAtual, uint32_t entrada) {
+        if(tamanho == capacidade) cresce();
+        No& novo = nos[posicao(tamanho)];
+        novo.paciente = paciente;
+        novo.entrada = entrada;
+        novo.tempoEntradaFila = tempoAtual;
+        tamanho++;
+    }
+
+    No retira() {
+        No primeiro = nos[cabeca];
+        cabeca = posicao(1);
+        tamanho--;
+        return primeiro;
+    }
+
+    const No& primeiro() const { return nos[cabeca]; }
+    const No& operator[](int i) const { return nos[posicao(i)]; }
+
+    void clear() {
+        cabeca = 0;
+        tamanho = 0;
+    }
+
+    // Troca o conteúdo com outro balde, sem copiar os nós
+    void troca(BaldeFila& outro) {
+        No* nosOutro = outro.nos;
+        int capacidadeOutro = outro.capacidade;
+        int cabecaOutro = outro.cabeca;
+        int tamanhoOutro = outro.tamanho;
+        outro.nos = nos;
+        outro.capacidade = capacidade;
+        outro.cabeca = cabeca;
+        outro.tamanho = tamanho;
+        nos = nosOutro;
+        capacidade = capacidadeOutro;
+        cabeca = cabecaOutro;
+        tamanho = tamanhoOutro;
+    }
+
+    bool vazio() const { return tamanho == 0; }
+    int getTamanho() const { return tamanho; }
+};
+
+// Fila de pacientes com um balde FIFO por nível de prioridade (grau) e uma
+// máscara de bits dos baldes não vazios. Enfileirar e desenfileirar são O(1)
+// para qualquer número de níveis; sai sempre o paciente mais antigo do maior
+// grau presente. Uma fila com um único nível é uma FIFO simples. Numa fila
+// por grau, os níveis crescem quando chega um grau acima do maior até
+// então, até MAX_NIVEIS; graus negativos vão para o nível 0 e os acima do
+// limite, para o último.
+class Fila {
+public:
+    static const int MAX_NIVEIS = 64;   // Limite da máscara de baldes
+
+private:
+    CadastroPacientes& pacientes;
+    BaldeFila* baldes;
+    int numPrioridades;
+    unsigned long long baldesOcupados;   // Bit p ligado se o balde p tem pacientes
     int tamanho;
-    std::string nomeProcedimento;  // Nome do Procedimento associado a essa fila
-    int prioridade;               // Prioridade dessa fila (se aplicável)
+    int id;                       // Identificador único da fila no hospital
+    int procedimento;             // ProcedimentoId associado a essa fila
 
     //Estatísticas
-    double tempoTotalEspera;
+    long long totalEntradas;
+    Tempo tempoTotalEspera;
     int pacientesAtendidos;
     int* historicoDeTamanho;    // Array para guardar tamanho da fila em diferentes tempos
     int capacidadeHistorico;
     int posicaoHistorico;
 
+    // Balde de um paciente, criando os níveis que faltarem numa fila por grau
+    int baldeDoPaciente(int paciente) {
+        if(numPrioridades == 1) return 0;
+        int grau = pacientes.getPrioridade(paciente);
+        if(grau < 0) return 0;
+        if(grau >= MAX_NIVEIS) grau = MAX_NIVEIS - 1;
+        if(grau >= numPrioridades) aumentaNiveis(grau + 1);
+        return grau;
+    }
+
+    void aumentaNiveis(int novoNumero) {
+        BaldeFila* novos = new BaldeFila[novoNumero];
+        for(int p = 0; p < numPrioridades; p++) {
+            novos[p].troca(baldes[p]);
+        }
+        delete[] baldes;
+        baldes = novos;
+        numPrioridades = novoNumero;
+    }
+
+    int maiorBaldeOcupado() const {
+        return 63 - __builtin_clzll(baldesOcupados);
+    }
+
+    int retiraDoBalde(int p, Tempo tempoAtual) {
+        BaldeFila::No primeiro = baldes[p].retira();
+        if(baldes[p].vazio()) baldesOcupados &= ~(1ULL << p);
+
+        // Registra estatísticas
+        tempoTotalEspera += (tempoAtual - primeiro.tempoEntradaFila);
+        pacientesAtendidos++;
+        pacientes.registraSaidaFila(primeiro.paciente);
+
+        tamanho--;
+        registraTamanho(tempoAtual);
+
+        return primeiro.paciente;
+    }
+
 public:
     // Construtor
-    Fila(const std::string& procedimento, int prioridade = 0, int capacidadeHistorico = 1000)
-        : inicio(nullptr), fim(nullptr), tamanho(0), nomeProcedimento(procedimento),
-          prioridade(prioridade), tempoTotalEspera(0), pacientesAtendidos(0),
+    Fila(CadastroPacientes& pacientes, int id, int procedimento, int numPrioridades = 1,
+         int capacidadeHistorico = 1000)
+        : pacientes(pacientes), numPrioridades(numPrioridades < 1 ? 1 : (numPrioridades > MAX_NIVEIS ? MAX_NIVEIS : numPrioridades)),
+          baldesOcupados(0), tamanho(0), id(id), procedimento(procedimento),
+          totalEntradas(0), tempoTotalEspera(0), pacientesAtendidos(0),
           capacidadeHistorico(capacidadeHistorico), posicaoHistorico(0) {
+            baldes = new BaldeFila[this->numPrioridades];
             historicoDeTamanho = new int[capacidadeHistorico];
             for(int i = 0; i < capacidadeHistorico; i++) {
                 historicoDeTamanho[i] = 0;
@@ -39,90 +173,76 @@ public:
 
     // Destrutor
     ~ Fila() {
-        while(inicio != nullptr) {
-            No* temp = inicio;
-            inicio = inicio->proximo;
-            delete temp;
-        }
+        delete[] baldes;
         delete[] historicoDeTamanho;
     }
 
     // Inicializa a fila
     void inicializa() {
-        while(inicio != nullptr) {
-            No* temp = inicio;
-            inicio = inicio->proximo;
-            delete temp;
+        for(int p = 0; p < numPrioridades; p++) {
+            for(int i = 0; i < baldes[p].getTamanho(); i++) {
+                pacientes.registraSaidaFila(baldes[p][i].paciente);
+            }
+            baldes[p].clear();
         }
-        fim = nullptr;
+        baldesOcupados = 0;
         tamanho = 0;
+        totalEntradas = 0;
         tempoTotalEspera = 0;
         pacientesAtendidos = 0;
         posicaoHistorico = 0;
     }
 
-    void enfileira(Paciente* paciente, double tempoAtual) {
-        No* novoNo = new No(paciente, tempoAtual);
-
-        if(filaVazia()) {
-            inicio = fim = novoNo;
-        } else {
-            // Se a fila tem prioridade, insere ordenado por prioridade
-            if(prioridade > 0) {
-                if(paciente->getPrioridade() > inicio->paciente->getPrioridade()) {
-                    novoNo->proximo = inicio;
-                    inicio = novoNo;
-                } else {
-                    No* atual = inicio;
-                    No* anterior = nullptr;
-
-                    while(atual != nullptr && paciente->getPrioridade() <= atual->paciente->getPrioridade()) {
-                            anterior = atual;
-                            atual = atual->proximo;
-                    }
-
-                    anterior->proximo = novoNo;
-                    novoNo->proximo = atual;
-                    if(atual == nullptr) fim = novoNo;
-                }
-            } else {
-                fim->proximo = novoNo;
-                fim = novoNo;
-            }
+    void enfileira(int paciente, Tempo tempoAtual) {
+        // Um paciente só pode estar em uma fila por vez
+        if(pacientes.getFilaAtual(paciente) != -1) {
+            throw std::logic_error("Paciente já está em uma fila");
         }
+
+        int p = baldeDoPaciente(paciente);
+        baldes[p].insere(paciente, tempoAtual, (uint32_t)totalEntradas);
+        baldesOcupados |= 1ULL << p;
+        pacientes.registraEntradaFila(paciente, id);
+        totalEntradas++;
+
         tamanho++;
         registraTamanho(tempoAtual);
     }
 
-    Paciente* desenfileira(double tempoAtual) {
-        if(filaVazia()) return nullptr;
-
-        No* temp = inicio;
-        Paciente* paciente = temp->paciente;
-        inicio = inicio->proximo;
-
-        if(inicio == nullptr) fim = nullptr;
-
-        // Registra estatísticas
-        tempoTotalEspera += (tempoAtual - temp->tempoEntradaFila);
-        pacientesAtendidos++;
-        tamanho--;
-
-        delete temp;
-        registraTamanho(tempoAtual);
+    // Devolve o índice do paciente, ou -1 se a fila estiver vazia
+    int desenfileira(Tempo tempoAtual) {
+        if(filaVazia()) return -1;
+        return retiraDoBalde(maiorBaldeOcupado(), tempoAtual);
+    }
 
-        return paciente;
+    // Como desenfileira, mas só entre os pacientes que já estavam na fila
+    // quando getTotalEntradas valia limite, no instante tempoAtual; -1 se
+    // nenhum deles estiver mais nela. Quem entrou antes de tempoAtual sempre
+    // conta, e entre os do instante a comparação dos números truncados vale
+    // enquanto eles forem menos de 2^31.
+    int desenfileiraAte(Tempo tempoAtual, long long limite) {
+        unsigned long long ocupados = baldesOcupados;
+        while(ocupados != 0) {
+            int p = 63 - __builtin_clzll(ocupados);
+            const BaldeFila::No& primeiro = baldes[p].primeiro();
+            if(primeiro.tempoEntradaFila < tempoAtual || (int32_t)((uint32_t)limite - primeiro.entrada) > 0) {
+                return retiraDoBalde(p, tempoAtual);
+            }
+            // O balde é FIFO: se o primeiro entrou depois, todos entraram
+            ocupados &= ~(1ULL << p);
+        }
+        return -1;
     }
 
     // Verifica se a fila está vazia
     bool filaVazia() const {
-        return inicio == nullptr;
+        return tamanho == 0;
     }
 
     // Finaliza a fila e retorna estatísticas
-    void finaliza(double tempoTotal, double& tempoMedioEspera, double& tamanhoMedioFila) {
+    void finaliza(Tempo tempoTotal, double& tempoMedioEspera, double& tamanhoMedioFila) {
         if(pacientesAtendidos > 0) {
-            tempoMedioEspera = tempoTotalEspera / pacientesAtendidos;
+            tempoMedioEspera = ticksParaHoras(tempoTotalEspera) / pacientesAtendidos;
             
             // Calcula tamanho médio da fila
             int somaTamanhos = 0;
@@ -138,7 +258,7 @@ public:
     }
 
     // Registra o tamanho da fila no histórico
-    void registraTamanho(double tempoAtual) {
+    void registraTamanho(Tempo tempoAtual) {
         if(posicaoHistorico < capacidadeHistorico) {
             historicoDeTamanho[posicaoHistorico++] = tamanho;
         }
@@ -146,60 +266,40 @@ public:
 
     // Getters
     int getTamanho() const { return tamanho; }
-    std::string getNomeProcedimento() const { return nomeProcedimento; }
-    int getPrioridade() const { return prioridade; }
+    int getId() const { return id; }
+    long long getTotalEntradas() const { return totalEntradas; }
+    int getProcedimento() const { return procedimento; }
+    const char* getNomeProcedimento() const { return nomeProcedimento(procedimento); }
+    int getNumPrioridades() const { return numPrioridades; }
+    int getTamanhoPrioridade(int grau) const {
+        return (grau >= 0 && grau < numPrioridades) ? baldes[grau].getTamanho() : 0;
+    }
     
     // Retorna o próximo paciente sem removê-lo da fila
-    Paciente* getProximoPaciente() const {
-        return filaVazia() ? nullptr : inicio->paciente;
-    }
-
-    // Verifica se um paciente específico já está na fila
-    bool contemPaciente(Paciente* paciente) const {
-        No* atual = inicio;
-        while (atual != nullptr) {
-            if (atual->paciente == paciente) {
-                return true;
-            }
-            atual = atual->proximo;
-        }
-        return false;
+    int getProximoPaciente() const {
+        return filaVazia() ? -1 : baldes[maiorBaldeOcupado()].primeiro().paciente;
     }
 };
 
 // Classe para gerenciar todas as filas do hospital
 class GerenciadorFilas {
 private:
-    static const int NUM_PROCEDIMENTOS = 6;
-    static const int MAX_PRIORIDADES = 3;
-    Fila*** filas;  // Matriz de filas [procedimento][prioridade]
+    static const int NUM_PROCEDIMENTOS = TOTAL_PROCEDIMENTOS;
+    int numPrioridades;
+    Fila** filas;  // Uma fila por procedimento
 
 public:
-    // Construtor
-    GerenciadorFilas() {
-        filas = new Fila**[NUM_PROCEDIMENTOS];
-        for(int i = 0; i < NUM_PROCEDIMENTOS; i++) {
-            filas[i] = new Fila*[MAX_PRIORIDADES];
-            for(int j = 0; j < MAX_PRIORIDADES; j++) {
-                filas[i][j] = nullptr;
-            }
-        }
-        
-        // Inicializa as filas necessárias
-        std::string procedimentos[] = {
-            "Triagem", "Atendimento", "Medidas", 
-            "Testes", "Imagem", "Instrumentos/Medicamentos"
-        };
-        
+    // Construtor. Triagem e Atendimento ordenam por grau, começando com
+    // numPrioridades níveis (pelo menos 2) e crescendo conforme os graus que
+    // chegam; os demais procedimentos têm fila única.
+    GerenciadorFilas(CadastroPacientes& pacientes, int numPrioridades = 3)
+        : numPrioridades(numPrioridades < 2 ? 2 : numPrioridades) {
+        filas = new Fila*[NUM_PROCEDIMENTOS];
         for(int i = 0; i < NUM_PROCEDIMENTOS; i++) {
-            // Triagem e Atendimento têm filas com prioridade
-            if(i <= 1) {
-                for(int p = 0; p < MAX_PRIORIDADES; p++) {
-                    filas[i][p] = new Fila(procedimentos[i], p + 1);
-                }
+            if(i == PROC_TRIAGEM || i == PROC_ATENDIMENTO) {
+                filas[i] = new Fila(pacientes, i, i, this->numPrioridades);
             } else {
-                // Outros procedimentos têm fila única
-                filas[i][0] = new Fila(procedimentos[i]);
+                filas[i] = new Fila(pacientes, i, i);
             }
         }
     }
@@ -207,37 +307,19 @@ public:
     // Destrutor
     ~GerenciadorFilas() {
         for(int i = 0; i < NUM_PROCEDIMENTOS; i++) {
-            for(int j = 0; j < MAX_PRIORIDADES; j++) {
-                delete filas[i][j];
-            }
-            delete[] filas[i];
+            delete filas[i];
         }
         delete[] filas;
     }
     
-    // Obtém a fila apropriada para um procedimento e prioridade
-    Fila* getFila(const std::string& procedimento, int prioridade = 0) {
-        int procIndex = getProcedimentoIndex(procedimento);
-        if(procIndex >= 0) {
-            // Para Triagem e Atendimento, usa a prioridade
-            if(procIndex <= 1 && prioridade > 0 && prioridade <= MAX_PRIORIDADES) {
-                return filas[procIndex][prioridade - 1];
-            }
-            // Para outros procedimentos, usa a fila única
-            return filas[procIndex][0];
+    // Obtém a fila de um procedimento
+    Fila* getFila(int procedimento) {
+        if(procedimento >= 0 && procedimento < NUM_PROCEDIMENTOS) {
+            return filas[procedimento];
         }
         return nullptr;
     }
-    
-private:
-    // Converte nome do procedimento para índice
-    int getProcedimentoIndex(const std::string& procedimento) {
-        if(procedimento == "Triagem") return 0;
-        if(procedimento == "Atendimento") return 1;
-        if(procedimento == "Medidas") return 2;
-        if(procedimento == "Testes") return 3;
-        if(procedimento == "Imagem") return 4;
-        if(procedimento == "Instrumentos/Medicamentos") return 5;
-        return -1;
-    }
+
+    // Níveis com que as filas por grau começam
+    int getNumPrioridades() const { return numPrioridades; }
 };
\ No newline at end of file
@@ -1,8 +1,13 @@
 #include <iostream>
 #include <string>
-#include <fstream>
+#include <chrono>
+#include <limits>
 
+#include "Log.cpp"
+#include "Saida.cpp"
 #include "Escalonador.cpp"
+#include "Leitor.cpp"
+#include "Relatorio.cpp"
 
 using namespace std;
 
@@ -11,9 +16,48 @@ private:
     GerenciadorFilas* gerenciadorFilas;
     GerenciadorProcedimentos* gerenciadorProcedimentos;
     Escalonador* escalonador;
-    PacienteArray pacientes;
+    CadastroPacientes pacientes;
 
-    double relogio;
+    Tempo relogio;
+
+    // Procedimentos que podem ter mudado desde o último escalonamento: bit p
+    // ligado quando a fila de p recebe alguém ou uma unidade de p termina.
+    // Uma unidade só é oferecida à fila quando o FIM_PROCEDIMENTO dela é
+    // processado, e não já no primeiro evento do mesmo instante; assim o
+    // paciente que sai dela e volta à mesma fila concorre pela própria unidade.
+    unsigned int procedimentosProntos;
+
+    // Modo em lote: os eventos de um mesmo instante são todos aplicados antes
+    // de uma única passada de escalonamento. Cada chegada ou fim de
+    // procedimento registra um passo com os procedimentos que marcou e, para
+    // cada um, as unidades livres e as entradas na fila até ali. A passada
+    // refaz os passos em ordem e cada um só vê as unidades e os pacientes que
+    // já havia, o que dá as mesmas atribuições de escalonar após cada evento.
+    struct PassoLote {
+        unsigned int prontos;
+        int livres[TOTAL_PROCEDIMENTOS];
+        long long entradas[TOTAL_PROCEDIMENTOS];
+    };
+
+    bool emLote;
+    long long passadasEscalonamento;
+    PassoLote* passosLote;
+    int numPassosLote;
+    int capacidadePassosLote;
+
+    // Modo em fluxo: o arquivo, ordenado por chegada, é lido um paciente por
+    // vez e só a próxima chegada fica agendada. O leitor fica aberto até a
+    // última chegada; nos demais modos só durante a carga.
+    bool emFluxo;
+    LeitorEntrada* leitor;
+    unsigned long long sequenciaChegadas;   // Sequência reservada da próxima chegada
+    Tempo ultimaChegada;                    // numeric_limits<Tempo>::min() até a primeira
+    bool falhaEntrada;
+
+    // Relatório na alta: a linha de cada paciente é escrita quando ele recebe
+    // alta e a sua posição no cadastro é liberada para as próximas chegadas.
+    // nullptr quando o relatório é gerado só no fim.
+    EscritorRelatorio* escritorAltas;
 
     struct Config {
         double tempo;
@@ -21,367 +65,702 @@ private:
     };
 
     void configurarProcedimentos(Config* configs) {
-        gerenciadorProcedimentos->setNumeroUnidades("Triagem", configs[0].tempo, configs[0].unidades);
-        gerenciadorProcedimentos->setNumeroUnidades("Atendimento", configs[1].tempo, configs[1].unidades);
-        gerenciadorProcedimentos->setNumeroUnidades("Medidas", configs[2].tempo, configs[2].unidades);
-        gerenciadorProcedimentos->setNumeroUnidades("Testes", configs[3].tempo, configs[3].unidades);
-        gerenciadorProcedimentos->setNumeroUnidades("Imagem", configs[4].tempo, configs[4].unidades);
-        gerenciadorProcedimentos->setNumeroUnidades("Instrumentos/Medicamentos", configs[5].tempo, configs[5].unidades);
+        // As configurações vêm na ordem dos ProcedimentoId
+        for(int i = 0; i < TOTAL_PROCEDIMENTOS; i++) {
+            gerenciadorProcedimentos->setNumeroUnidades(i, horasParaTicks(configs[i].tempo), configs[i].unidades);
+        }
     }
 
      // Processa um evento do escalonador
-    void processaEvento(Evento* evento) {
-        Paciente* paciente = evento->getPaciente();
-        double tempoAtual = evento->getDataHora();
+    void processaEvento(const Evento& evento) {
+        int paciente = evento.getPaciente();
+        Tempo tempoAtual = escalonador->getTempoAtual();
         
-        // std::cout << "Processando evento para paciente " << paciente->getId() 
-        //         << " no tempo " << tempoAtual 
-        //         << "h, tipo: " << evento->getTipo() << std::endl << std::endl;
+        // std::cout << "Processando evento para paciente " << pacientes.getId(paciente) 
+        //         << " no tempo " << ticksParaHoras(tempoAtual) 
+        //         << "h, tipo: " << evento.getTipo() << std::endl << std::endl;
         
-        switch(evento->getTipo()) {
-            case Escalonador::CHEGADA_PACIENTE:
-                // std::cout << "Chegada do paciente " << paciente->getId() << std::endl;
+        switch(evento.getTipo()) {
+            case Evento::CHEGADA_PACIENTE:
+                // std::cout << "Chegada do paciente " << pacientes.getId(paciente) << std::endl;
                 processaChegada(paciente, tempoAtual);
                 break;
                 
-            case Escalonador::INICIO_PROCEDIMENTO:
-                // std::cout << "Início de " << evento->getProcedimento() 
-                //         << " para paciente " << paciente->getId() << std::endl;
-                processaInicioProcedimento(paciente, tempoAtual, evento->getProcedimento());
+            case Evento::INICIO_PROCEDIMENTO:
+                // std::cout << "Início de " << nomeProcedimento(evento.getProcedimento()) 
+                //         << " para paciente " << pacientes.getId(paciente) << std::endl;
+                processaInicioProcedimento(paciente, tempoAtual, evento.getProcedimento(), evento.getUnidade());
                 break;
                 
-            case Escalonador::FIM_PROCEDIMENTO:
-                // std::cout << "Fim de " << evento->getProcedimento() 
-                //         << " para paciente " << paciente->getId() << std::endl;
-                processaFimProcedimento(paciente, tempoAtual, evento->getProcedimento());
+            case Evento::FIM_PROCEDIMENTO:
+                // std::cout << "Fim de " << nomeProcedimento(evento.getProcedimento()) 
+                //         << " para paciente " << pacientes.getId(paciente) << std::endl;
+                processaFimProcedimento(paciente, tempoAtual, evento.getProcedimento(), evento.getUnidade());
                 break;
         }
         
-        // Só verifica as filas após chegada ou fim de procedimento
-        if (evento->getTipo() != Escalonador::INICIO_PROCEDIMENTO) {
-            verificaFilasEEscalona(tempoAtual);
+        // Só verifica as filas após chegada ou fim de procedimento; em lote a
+        // verificação fica para o fim do instante
+        if (evento.getTipo() != Evento::INICIO_PROCEDIMENTO) {
+            if (emLote) {
+                registraPassoLote();
+            } else {
+                verificaFilasEEscalona(tempoAtual);
+            }
         }
-        
-        delete evento;
     }
 
-    void processaChegada(Paciente* paciente, double tempoAtual) {
-        // std::cout << "Processando chegada do paciente " << paciente->getId() 
-        //         << " no tempo " << tempoAtual 
-        //         << " com prioridade " << paciente->getPrioridade() << "\n";
+    void processaChegada(int paciente, Tempo tempoAtual) {
+        // std::cout << "Processando chegada do paciente " << pacientes.getId(paciente) 
+        //         << " no tempo " << ticksParaHoras(tempoAtual) 
+        //         << " com prioridade " << pacientes.getPrioridade(paciente) << "\n";
         
         // Coloca o paciente na fila de triagem
-        Fila* filaTriagem = gerenciadorFilas->getFila("Triagem", paciente->getPrioridade());
+        Fila* filaTriagem = gerenciadorFilas->getFila(PROC_TRIAGEM);
         if (filaTriagem == nullptr) {
             // std::cout << "ERRO: Fila de triagem não encontrada!\n";
             return;
         }
         
-        paciente->entrarFila("Triagem", tempoAtual);
+        pacientes.entrarFila(paciente, PROC_TRIAGEM, tempoAtual);
         filaTriagem->enfileira(paciente, tempoAtual);
-        // std::cout << "Paciente " << paciente->getId() << " entrou na fila de triagem\n";
-        
-        // Verifica se pode começar o atendimento imediatamente
-        verificaFilasEEscalona(tempoAtual);
+        marcaPronto(PROC_TRIAGEM);
+
+        if (leitor != nullptr && !agendaProximaChegada()) {
+            falhaEntrada = true;
+        }
+        // std::cout << "Paciente " << pacientes.getId(paciente) << " entrou na fila de triagem\n";
     }
 
-    void processaInicioProcedimento(Paciente* paciente, double tempoAtual, const std::string& nomeProcedimento) {
-        Procedimento* proc = gerenciadorProcedimentos->getProcedimento(nomeProcedimento);
-        int unidadeDisponivel = proc->getUnidadeDisponivel(tempoAtual);
+    // O escalonamento já ocupou a unidade que vem no evento
+    void processaInicioProcedimento(int paciente, Tempo tempoAtual, int procedimento, int unidade) {
+        Procedimento* proc = gerenciadorProcedimentos->getProcedimento(procedimento);
+        iniciaNaUnidade(paciente, proc, unidade, tempoAtual);
+    }
+
+    // Inicia o atendimento na unidade já ocupada e agenda o fim, que devolve
+    // a mesma unidade
+    void iniciaNaUnidade(int paciente, Procedimento* proc, int unidade, Tempo tempoAtual) {
+        pacientes.iniciarAtendimento(paciente, proc->getId(), tempoAtual);
         
-        if(unidadeDisponivel >= 0) {
-            // Primeiro ocupa a unidade
-            proc->ocuparUnidade(unidadeDisponivel, tempoAtual, paciente->getId(), paciente->getEstadoAtual());
-            
-            // Depois inicia o atendimento do paciente
-            paciente->iniciarAtendimento(nomeProcedimento, tempoAtual);
-            
-            // Agenda o fim do procedimento
-            double tempoFim = tempoAtual + proc->getTempoMedio();
-            escalonador->insereEvento(tempoFim, Escalonador::FIM_PROCEDIMENTO, paciente, nomeProcedimento);
-            
-            std::cout << "Iniciando " << nomeProcedimento << " para paciente " << paciente->getId() 
-                     << " no tempo " << tempoAtual << std::endl;
-        } else {
-            std::cout << "Não há unidade disponível para o procedimento " << nomeProcedimento 
-                     << " para o paciente " << paciente->getId() 
-                     << " no tempo " << tempoAtual << std::endl;
-            
-            // Se não há unidade disponível, coloca o paciente de volta na fila
-            Fila* fila = gerenciadorFilas->getFila(nomeProcedimento, paciente->getPrioridade());
-            if (fila && !fila->contemPaciente(paciente)) {
-                // Não registrar novo tempo de espera ao retornar para a fila
-                fila->enfileira(paciente, tempoAtual);
-                
-                // Agenda uma nova tentativa após um intervalo
-                double proximaTentativa = tempoAtual;
-                escalonador->insereEvento(proximaTentativa, Escalonador::INICIO_PROCEDIMENTO, 
-                                        paciente, nomeProcedimento);
-            }
-            
-            return;
-        }
+        Tempo tempoFim = tempoAtual + proc->getTempoMedio();
+        escalonador->insereEvento(tempoFim, Evento::FIM_PROCEDIMENTO, paciente, proc->getId(), unidade);
+        
+        LOG_TRACE("Iniciando " << proc->getNome() << " para paciente " << pacientes.getId(paciente) 
+                 << " no tempo " << ticksParaHoras(tempoAtual));
     }
 
-    void processaFimProcedimento(Paciente* paciente, double tempoAtual, const std::string& nomeProcedimento) {
-        std::cout << "Fim do procedimento " << nomeProcedimento 
-                  << " para paciente " << paciente->getId()
-                  << " no tempo " << tempoAtual 
-                  << " (Tempo total atendimento até agora: " << paciente->getTempoTotalAtendimento() 
+    void processaFimProcedimento(int paciente, Tempo tempoAtual, int procedimento, int unidade) {
+        LOG_TRACE("Fim do procedimento " << nomeProcedimento(procedimento)
+                  << " para paciente " << pacientes.getId(paciente)
+                  << " no tempo " << ticksParaHoras(tempoAtual) 
+                  << " (Tempo total atendimento até agora: " << ticksParaHoras(pacientes.getTempoTotalAtendimento(paciente)) 
                   << ", Procedimentos restantes: "
-                  << "Medidas=" << paciente->precisaMedidasHospitalares()
-                  << ", Testes=" << paciente->precisaTestesLaboratorio()
-                  << ", Imagem=" << paciente->precisaExamesImagem()
-                  << ", Instrumentos=" << paciente->precisaInstrumentosMedicamentos()
-                  << ")" << std::endl;    
+                  << "Medidas=" << pacientes.precisaMedidasHospitalares(paciente)
+                  << ", Testes=" << pacientes.precisaTestesLaboratorio(paciente)
+                  << ", Imagem=" << pacientes.precisaExamesImagem(paciente)
+                  << ", Instrumentos=" << pacientes.precisaInstrumentosMedicamentos(paciente)
+                  << ")");
+
+        // A unidade usada fica disponível para o próximo da fila do procedimento
+        Procedimento* proc = gerenciadorProcedimentos->getProcedimento(procedimento);
+        proc->liberarUnidade(unidade, tempoAtual);
+        marcaPronto(procedimento);
 
         // Decrementa o contador do procedimento realizado
-        paciente->decrementarProcedimento(nomeProcedimento);
+        pacientes.decrementarProcedimento(paciente, procedimento);
         
         // Adiciona verificação específica para triagem
-        if(nomeProcedimento == "Triagem") {
-            encaminhaParaFila(paciente, "Atendimento", tempoAtual);
+        if(procedimento == PROC_TRIAGEM) {
+            encaminhaParaFila(paciente, PROC_ATENDIMENTO, tempoAtual);
         }
         // Após atendimento, verifica se precisa alta
-        else if(nomeProcedimento == "Atendimento") {
-            if(paciente->precisaAlta()) {
+        else if(procedimento == PROC_ATENDIMENTO) {
+            if(pacientes.precisaAlta(paciente)) {
                 // Garante que o tempo do atendimento seja contabilizado antes da alta
-                paciente->finalizarAtendimento(tempoAtual);
-                std::cout << "Alta do paciente " << paciente->getId() 
-                          << " no tempo " << tempoAtual 
-                          << "\nTempo total de atendimento: " << paciente->getTempoTotalAtendimento() 
-                          << "\nTempo total de espera: " << paciente->getTempoTotalEspera() 
-                          << "\nProcedimentos realizados: Triagem, Atendimento" << std::endl;
+                pacientes.finalizarAtendimento(paciente, tempoAtual);
+                LOG_DEBUG("Alta do paciente " << pacientes.getId(paciente) 
+                          << " no tempo " << ticksParaHoras(tempoAtual) 
+                          << "\nTempo total de atendimento: " << ticksParaHoras(pacientes.getTempoTotalAtendimento(paciente)) 
+                          << "\nTempo total de espera: " << ticksParaHoras(pacientes.getTempoTotalEspera(paciente)) 
+                          << "\nProcedimentos realizados: Triagem, Atendimento");
+                retiraSeRelatorioNaAlta(paciente);
                 return;
             }
             // Se não precisa alta, continua para o próximo procedimento disponível
-            if(paciente->precisaMedidasHospitalares()) {
-                encaminhaParaFila(paciente, "Medidas", tempoAtual);
-            } else if(paciente->precisaTestesLaboratorio()) {
-                encaminhaParaFila(paciente, "Testes", tempoAtual);
-            } else if(paciente->precisaExamesImagem()) {
-                encaminhaParaFila(paciente, "Imagem", tempoAtual);
-            } else if(paciente->precisaInstrumentosMedicamentos()) {
-                encaminhaParaFila(paciente, "Instrumentos/Medicamentos", tempoAtual);
+            if(pacientes.precisaMedidasHospitalares(paciente)) {
+                encaminhaParaFila(paciente, PROC_MEDIDAS, tempoAtual);
+            } else if(pacientes.precisaTestesLaboratorio(paciente)) {
+                encaminhaParaFila(paciente, PROC_TESTES, tempoAtual);
+            } else if(pacientes.precisaExamesImagem(paciente)) {
+                encaminhaParaFila(paciente, PROC_IMAGEM, tempoAtual);
+            } else if(pacientes.precisaInstrumentosMedicamentos(paciente)) {
+                encaminhaParaFila(paciente, PROC_INSTRUMENTOS, tempoAtual);
             }
         }
         // Para outros procedimentos, verifica se precisa retornar à mesma fila
         else {
             // Verifica se ainda precisa do mesmo procedimento
-            if(nomeProcedimento == "Medidas" && paciente->precisaMedidasHospitalares()) {
-                encaminhaParaFila(paciente, "Medidas", tempoAtual);
-            } else if(nomeProcedimento == "Testes" && paciente->precisaTestesLaboratorio()) {
-                encaminhaParaFila(paciente, "Testes", tempoAtual);
-            } else if(nomeProcedimento == "Imagem" && paciente->precisaExamesImagem()) {
-                encaminhaParaFila(paciente, "Imagem", tempoAtual);
-            } else if(nomeProcedimento == "Instrumentos/Medicamentos" && paciente->precisaInstrumentosMedicamentos()) {
-                encaminhaParaFila(paciente, "Instrumentos/Medicamentos", tempoAtual);
+            if(procedimento == PROC_MEDIDAS && pacientes.precisaMedidasHospitalares(paciente)) {
+                encaminhaParaFila(paciente, PROC_MEDIDAS, tempoAtual);
+            } else if(procedimento == PROC_TESTES && pacientes.precisaTestesLaboratorio(paciente)) {
+                encaminhaParaFila(paciente, PROC_TESTES, tempoAtual);
+            } else if(procedimento == PROC_IMAGEM && pacientes.precisaExamesImagem(paciente)) {
+                encaminhaParaFila(paciente, PROC_IMAGEM, tempoAtual);
+            } else if(procedimento == PROC_INSTRUMENTOS && pacientes.precisaInstrumentosMedicamentos(paciente)) {
+                encaminhaParaFila(paciente, PROC_INSTRUMENTOS, tempoAtual);
             }
             // Se não precisa mais do procedimento atual, verifica o próximo
-            else if(paciente->precisaMedidasHospitalares()) {
-                encaminhaParaFila(paciente, "Medidas", tempoAtual);
-            } else if(paciente->precisaTestesLaboratorio()) {
-                encaminhaParaFila(paciente, "Testes", tempoAtual);
-            } else if(paciente->precisaExamesImagem()) {
-                encaminhaParaFila(paciente, "Imagem", tempoAtual);
-            } else if(paciente->precisaInstrumentosMedicamentos()) {
-                encaminhaParaFila(paciente, "Instrumentos/Medicamentos", tempoAtual);
+            else if(pacientes.precisaMedidasHospitalares(paciente)) {
+                encaminhaParaFila(paciente, PROC_MEDIDAS, tempoAtual);
+            } else if(pacientes.precisaTestesLaboratorio(paciente)) {
+                encaminhaParaFila(paciente, PROC_TESTES, tempoAtual);
+            } else if(pacientes.precisaExamesImagem(paciente)) {
+                encaminhaParaFila(paciente, PROC_IMAGEM, tempoAtual);
+            } else if(pacientes.precisaInstrumentosMedicamentos(paciente)) {
+                encaminhaParaFila(paciente, PROC_INSTRUMENTOS, tempoAtual);
             } else {
-                paciente->finalizarAtendimento(tempoAtual);
-                std::cout << "Alta do paciente " << paciente->getId() 
-                          << " no tempo " << tempoAtual 
-                          << "\nTempo total de atendimento: " << paciente->getTempoTotalAtendimento() 
-                          << "\nTempo total de espera: " << paciente->getTempoTotalEspera() 
-                          << "\nProcedimentos realizados: " << nomeProcedimento << std::endl;
+                pacientes.finalizarAtendimento(paciente, tempoAtual);
+                LOG_DEBUG("Alta do paciente " << pacientes.getId(paciente) 
+                          << " no tempo " << ticksParaHoras(tempoAtual) 
+                          << "\nTempo total de atendimento: " << ticksParaHoras(pacientes.getTempoTotalAtendimento(paciente)) 
+                          << "\nTempo total de espera: " << ticksParaHoras(pacientes.getTempoTotalEspera(paciente)) 
+                          << "\nProcedimentos realizados: " << nomeProcedimento(procedimento));
+                retiraSeRelatorioNaAlta(paciente);
             }
         }
-        
-        verificaFilasEEscalona(tempoAtual);
     }
 
-    void encaminhaParaFila(Paciente* paciente, const std::string& procedimento, double tempoAtual) {
-        Fila* fila = gerenciadorFilas->getFila(procedimento, paciente->getPrioridade());
-        paciente->entrarFila(procedimento, tempoAtual);
+    // No relatório na alta, escreve a linha do paciente e libera a sua posição
+    void retiraSeRelatorioNaAlta(int paciente) {
+        if (escritorAltas == nullptr) {
+            return;
+        }
+        escreveLinhaRelatorio(*escritorAltas, paciente);
+        pacientes.libera(paciente);
+    }
+
+    // Uma linha por paciente: id, admissão, tempo total, atendimento e espera
+    void escreveLinhaRelatorio(EscritorRelatorio& escritor, int paciente) {
+        Tempo espera = pacientes.getTempoTotalEspera(paciente);
+        Tempo atendimento = pacientes.getTempoTotalAtendimento(paciente);
+
+        escritor.iniciaLinha();
+        escritor.escreveInteiro(pacientes.getId(paciente));
+        escritor.escreveCaractere(' ');
+        escritor.escreveData(pacientes.getTempoAdmissao(paciente));
+        escritor.escreveCaractere(' ');
+        escritor.escreveReal(ticksParaHoras(espera + atendimento));
+        escritor.escreveCaractere(' ');
+        escritor.escreveReal(ticksParaHoras(atendimento));
+        escritor.escreveCaractere(' ');
+        escritor.escreveReal(ticksParaHoras(espera));
+        escritor.escreveCaractere('\n');
+    }
+
+    void encaminhaParaFila(int paciente, int procedimento, Tempo tempoAtual) {
+        Fila* fila = gerenciadorFilas->getFila(procedimento);
+        pacientes.entrarFila(paciente, procedimento, tempoAtual);
         fila->enfileira(paciente, tempoAtual);
+        marcaPronto(procedimento);
     }
 
-    void verificaFilasEEscalona(double tempoAtual) {
-        // Verifica todas as filas em ordem de prioridade
-        std::string procedimentos[] = {
-            "Triagem", "Atendimento", "Medidas", 
-            "Testes", "Imagem", "Instrumentos/Medicamentos"
-        };
-        
-        for(const auto& nomeProcedimento : procedimentos) {
-            Procedimento* proc = gerenciadorProcedimentos->getProcedimento(nomeProcedimento);
-            
-            // Para triagem e atendimento, verifica filas por prioridade
-            if(nomeProcedimento == "Triagem" || nomeProcedimento == "Atendimento") {
-                for(int prioridade = 2; prioridade >= 0; prioridade--) {
-                    Fila* fila = gerenciadorFilas->getFila(nomeProcedimento, prioridade);
-                    verificaFilaEEscalona(fila, proc, tempoAtual);
-                }
-            } else {
-                Fila* fila = gerenciadorFilas->getFila(nomeProcedimento);
-                verificaFilaEEscalona(fila, proc, tempoAtual);
-            }
+    void marcaPronto(int procedimento) {
+        procedimentosProntos |= 1u << procedimento;
+    }
+
+    void verificaFilasEEscalona(Tempo tempoAtual) {
+        if (procedimentosProntos == 0) {
+            return;
+        }
+        passadasEscalonamento++;
+
+        // Verifica só as filas marcadas como prontas, na ordem dos procedimentos;
+        // cada fila já entrega os pacientes por grau
+        while(procedimentosProntos != 0) {
+            int procedimento = __builtin_ctz(procedimentosProntos);
+            procedimentosProntos &= procedimentosProntos - 1;
+
+            Procedimento* proc = gerenciadorProcedimentos->getProcedimento(procedimento);
+            Fila* fila = gerenciadorFilas->getFila(procedimento);
+            verificaFilaEEscalona(fila, proc, tempoAtual);
         }
     }
 
-    void verificaFilaEEscalona(Fila* fila, Procedimento* proc, double tempoAtual) {
+    void verificaFilaEEscalona(Fila* fila, Procedimento* proc, Tempo tempoAtual) {
         if (fila == nullptr || proc == nullptr) {
-            std::cout << "ERRO: Fila ou procedimento nulo!\n";
+            LOG_ERRO("ERRO: Fila ou procedimento nulo!");
             return;
         }
         
-        while(!fila->filaVazia() && proc->temUnidadeDisponivel(tempoAtual)) {
-            Paciente* paciente = fila->desenfileira(tempoAtual);
-            std::cout << "Escalonando início de " << proc->getNome() 
-                    << " para paciente " << paciente->getId() 
-                    << " no tempo " << tempoAtual << "\n";
-                    
-            escalonador->insereEvento(tempoAtual, Escalonador::INICIO_PROCEDIMENTO, 
-                                    paciente, proc->getNome());
+        // Cada paciente retirado já ocupa a sua unidade, que segue no
+        // INICIO_PROCEDIMENTO: a fila só entrega tantos pacientes quantas
+        // unidades livres houver, e os demais continuam nela na ordem de grau.
+        // A fila é a espera por unidade; cada liberação acorda um paciente.
+        while(!fila->filaVazia() && proc->temUnidadeDisponivel()) {
+            escalonaInicio(fila->desenfileira(tempoAtual), proc, tempoAtual);
         }
     }
 
+    void escalonaInicio(int paciente, Procedimento* proc, Tempo tempoAtual) {
+        int unidade = proc->ocuparUnidade(tempoAtual, pacientes.getId(paciente), pacientes.getEstadoAtual(paciente));
+        LOG_TRACE("Escalonando início de " << proc->getNome() 
+                << " para paciente " << pacientes.getId(paciente) 
+                << " no tempo " << ticksParaHoras(tempoAtual));
+                
+        escalonador->insereEvento(tempoAtual, Evento::INICIO_PROCEDIMENTO, 
+                                paciente, proc->getId(), unidade);
+    }
+
+    // Em lote, guarda o que o evento recém-aplicado marcou como pronto
+    void registraPassoLote() {
+        if (procedimentosProntos == 0) {
+            return;
+        }
+        if (numPassosLote == capacidadePassosLote) {
+            PassoLote* novos = new PassoLote[capacidadePassosLote * 2];
+            for (int i = 0; i < numPassosLote; i++) {
+                novos[i] = passosLote[i];
+            }
+            delete[] passosLote;
+            passosLote = novos;
+            capacidadePassosLote *= 2;
+        }
+
+        PassoLote& passo = passosLote[numPassosLote++];
+        passo.prontos = procedimentosProntos;
+        for (unsigned int prontos = procedimentosProntos; prontos != 0; prontos &= prontos - 1) {
+            int procedimento = __builtin_ctz(prontos);
+            passo.livres[procedimento] = gerenciadorProcedimentos->getProcedimento(procedimento)->getNumLivres();
+            passo.entradas[procedimento] = gerenciadorFilas->getFila(procedimento)->getTotalEntradas();
+        }
+        procedimentosProntos = 0;
+    }
+
+    // A passada única do instante em lote: refaz os passos registrados. As
+    // unidades livres num passo são as que havia nele menos as já ocupadas
+    // pelos passos anteriores.
+    void escalonaLote(Tempo tempoAtual) {
+        if (numPassosLote == 0) {
+            return;
+        }
+        passadasEscalonamento++;
+
+        int ocupadas[TOTAL_PROCEDIMENTOS] = {0};
+        for (int i = 0; i < numPassosLote; i++) {
+            const PassoLote& passo = passosLote[i];
+            for (unsigned int prontos = passo.prontos; prontos != 0; prontos &= prontos - 1) {
+                int procedimento = __builtin_ctz(prontos);
+                Procedimento* proc = gerenciadorProcedimentos->getProcedimento(procedimento);
+                Fila* fila = gerenciadorFilas->getFila(procedimento);
+                while (passo.livres[procedimento] > ocupadas[procedimento]) {
+                    int paciente = fila->desenfileiraAte(tempoAtual, passo.entradas[procedimento]);
+                    if (paciente < 0) break;
+                    escalonaInicio(paciente, proc, tempoAtual);
+                    ocupadas[procedimento]++;
+                }
+            }
+        }
+        numPassosLote = 0;
+    }
+
+    // Lê o próximo paciente do fluxo e agenda a sua chegada com a sequência
+    // reservada para ele, o que mantém a ordem da carga completa. Fecha o
+    // leitor após o último registro; false (com a mensagem em stderr) se a
+    // entrada estiver mal formada ou fora de ordem.
+    bool agendaProximaChegada() {
+        int paciente = leitor->leProximoPaciente(pacientes);
+        if (paciente < 0) {
+            if (!leitor->getErro().empty()) {
+                LOG_ERRO("Erro em " << leitor->getNome() << ", " << leitor->getErro());
+                return false;
+            }
+            delete leitor;
+            leitor = nullptr;
+            return true;
+        }
+
+        if (pacientes.getTempoAdmissao(paciente) < ultimaChegada) {
+            LOG_ERRO("Erro em " << leitor->getNome() << ", " << leitor->getPosicaoLida()
+                     << ": chegada anterior à do paciente precedente; o modo em fluxo exige"
+                     << " o arquivo ordenado por data e hora");
+            return false;
+        }
+        // A primeira chegada do arquivo ordenado é a origem dos tempos
+        if (ultimaChegada == std::numeric_limits<Tempo>::min()) {
+            escalonador->defineTempoInicial(pacientes.getTempoAdmissao(paciente));
+        }
+        ultimaChegada = pacientes.getTempoAdmissao(paciente);
+
+        escalonador->insereEventoComSequencia(pacientes.getTempoAdmissao(paciente), sequenciaChegadas++,
+                                              Evento::CHEGADA_PACIENTE, paciente);
+        return true;
+    }
+
 public:
-    Hospital() {
-        gerenciadorFilas = new GerenciadorFilas();
+    Hospital(int conjuntoEventos = Escalonador::CONJUNTO_HEAP, bool _emLote = false, bool _emFluxo = false,
+             bool comHistorico = true, const std::string& diretorioCadastro = "")
+        : pacientes(comHistorico, diretorioCadastro), procedimentosProntos(0), emLote(_emLote), passadasEscalonamento(0),
+          numPassosLote(0), capacidadePassosLote(16), emFluxo(_emFluxo),
+          leitor(nullptr), sequenciaChegadas(0),
+          ultimaChegada(std::numeric_limits<Tempo>::min()), falhaEntrada(false),
+          escritorAltas(nullptr) {
+        gerenciadorFilas = new GerenciadorFilas(pacientes);
         gerenciadorProcedimentos = new GerenciadorProcedimentos();
-        escalonador = new Escalonador();
+        escalonador = new Escalonador(0, conjuntoEventos);
+        passosLote = new PassoLote[capacidadePassosLote];
     }
     
     ~Hospital() {
         delete gerenciadorFilas;
         delete gerenciadorProcedimentos;
         delete escalonador;
+        delete leitor;
+        delete escritorAltas;
+        delete[] passosLote;
     }
     
-    void carregaArquivo(const std::string& nomeArquivo) {
-        std::ifstream arquivo(nomeArquivo);
-        if(!arquivo.is_open()) {
-            std::cerr << "Erro ao abrir arquivo: " << nomeArquivo << std::endl;
-            return;
+    // Lê o arquivo de entrada e agenda as chegadas; false (com a mensagem em
+    // stderr) se o arquivo não puder ser lido ou estiver mal formado
+    bool carregaArquivo(const std::string& nomeArquivo) {
+        std::chrono::steady_clock::time_point inicioCarga = std::chrono::steady_clock::now();
+        leitor = new LeitorEntrada();
+        if(!leitor->abre(nomeArquivo)) {
+            LOG_ERRO("Erro ao abrir arquivo: " << leitor->getErro());
+            return false;
         }
         
-        std::cout << "Arquivo aberto com sucesso\n";
+        LOG_INFO("Arquivo aberto com sucesso");
         
-        // Lê configurações do hospital
+        // Lê configurações do hospital, do texto ou do cabeçalho binário
+        double tempos[6];
+        int unidades[6];
+        int numPacientes;
+        if(!leitor->leCabecalho(tempos, unidades, numPacientes)) {
+            LOG_ERRO("Erro em " << nomeArquivo << ", " << leitor->getErro());
+            return false;
+        }
+
         Config* configuracoes = new Config[6];
         for(int i = 0; i < 6; i++) {
-            arquivo >> configuracoes[i].tempo >> configuracoes[i].unidades;
-            std::cout << "Configuração " << i << ": tempo=" << configuracoes[i].tempo << ", unidades=" << configuracoes[i].unidades << "\n";
+            configuracoes[i].tempo = tempos[i];
+            configuracoes[i].unidades = unidades[i];
+            LOG_INFO("Configuração " << i << ": tempo=" << configuracoes[i].tempo << ", unidades=" << configuracoes[i].unidades);
         }
         
         configurarProcedimentos(configuracoes);
         delete[] configuracoes;
         
-        int numPacientes;
-        arquivo >> numPacientes;
-        std::cout << "Número de pacientes a serem lidos: " << numPacientes << "\n";
+        LOG_INFO("Número de pacientes a serem lidos: " << numPacientes);
         
-        // Lê todos os pacientes
-        for(int i = 0; i < numPacientes; i++) {
-            int id, alta, ano, mes, dia, hora, grau;
-            int medidas, testes, imagem, instrumentos;
-            
-            arquivo >> id >> alta >> ano >> mes >> dia >> hora 
-                >> grau >> medidas >> testes >> imagem >> instrumentos;
-                        
-            Paciente* paciente = new Paciente(id, alta, ano, mes, dia, hora,
-                                            grau, medidas, testes, imagem, instrumentos);
-            
-            // std::cout << "Criando evento de chegada para paciente " << id 
-            //         << " no tempo " << paciente->getAnoChegado() << " " << paciente->getMesChegado() << " " << paciente->getDiaChegado() << " " << paciente->getHoraChegada() << "\n";
-                    
-            escalonador->insereEvento(paciente->getHoraChegada(), Escalonador::CHEGADA_PACIENTE, paciente);
-            pacientes.push_back(paciente);
+        if(emFluxo) {
+            // Só a primeira chegada é lida agora; as chegadas ficam com as
+            // primeiras sequências, como na carga completa
+            if(!leitor->iniciaFluxo(numPacientes)) {
+                LOG_ERRO("Erro em " << nomeArquivo << ", " << leitor->getErro());
+                return false;
+            }
+            sequenciaChegadas = escalonador->reservaSequencias(numPacientes);
+            if(!agendaProximaChegada()) {
+                return false;
+            }
+            LOG_INFO("Carga do cabeçalho concluída em " << std::chrono::duration<double>(std::chrono::steady_clock::now() - inicioCarga).count() << " s");
+            return true;
         }
+
+        // Lê todos os pacientes de uma vez, em paralelo
+        int primeiro = pacientes.size();
+        if(!leitor->lePacientes(pacientes, numPacientes)) {
+            LOG_ERRO("Erro em " << nomeArquivo << ", " << leitor->getErro());
+            return false;
+        }
+
+        // A chegada mais cedo é a origem dos tempos do escalonador
+        if(primeiro < pacientes.size()) {
+            Tempo tempoInicial = pacientes.getTempoAdmissao(primeiro);
+            for(int paciente = primeiro + 1; paciente < pacientes.size(); paciente++) {
+                if(pacientes.getTempoAdmissao(paciente) < tempoInicial) {
+                    tempoInicial = pacientes.getTempoAdmissao(paciente);
+                }
+            }
+            escalonador->defineTempoInicial(tempoInicial);
+        }
+
+        // As chegadas entram na ordem do arquivo, que desempata as simultâneas
+        for(int paciente = primeiro; paciente < pacientes.size(); paciente++) {
+            escalonador->insereEventoEmCarga(pacientes.getTempoAdmissao(paciente), Evento::CHEGADA_PACIENTE, paciente);
+        }
+        escalonador->concluiCarga();
+        pacientes.concluiCarga();
+        delete leitor;
+        leitor = nullptr;
         
-        std::cout << "Total de eventos após carregar: " << escalonador->tamanho() << "\n";
-        
-        arquivo.close();
+        LOG_INFO("Total de eventos após carregar: " << escalonador->tamanho());
+        LOG_INFO("Carga concluída em " << std::chrono::duration<double>(std::chrono::steady_clock::now() - inicioCarga).count() << " s");
+        return true;
     }
     
-    void executaSimulacao() {   
-        std::cout << "Iniciando simulação\n";
+    // Executa até esgotar os eventos; false se a leitura em fluxo falhou
+    bool executaSimulacao() {   
+        LOG_INFO("Iniciando simulação");
 
-        std::cout << "Número de eventos inicial: " << escalonador->tamanho() << "\n";
+        LOG_INFO("Número de eventos inicial: " << escalonador->tamanho());
         
-        while(!escalonador->vazio()) {
-            Evento* evento = escalonador->retiraProximoEvento();
-            
-            processaEvento(evento);
-            
-            // Atualiza estatísticas
-            gerenciadorProcedimentos->atualizarTemposOciosos(escalonador->getTempoAtual());
+        // A ociosidade das unidades é contada a partir do primeiro evento
+        if(!escalonador->vazio()) {
+            gerenciadorProcedimentos->iniciaObservacao(escalonador->getProximoTempo());
+        }
+
+        while(!escalonador->vazio() && !falhaEntrada) {
+            if(!emLote) {
+                processaEvento(escalonador->retiraProximoEvento());
+                continue;
+            }
+
+            // Aplica todos os eventos do instante e escalona uma vez; os inícios
+            // agendados pelo escalonamento caem no mesmo instante e geram nova
+            // rodada, que só escalona de novo se algum procedimento durar zero
+            Tempo instante = escalonador->getProximoTempo();
+            do {
+                while(!escalonador->vazio() && escalonador->getProximoTempo() == instante) {
+                    processaEvento(escalonador->retiraProximoEvento());
+                }
+                escalonaLote(instante);
+            } while(!escalonador->vazio() && escalonador->getProximoTempo() == instante);
+        }
+
+        if(falhaEntrada) {
+            return false;
         }
         
-        std::cout << "Simulação finalizada\n";
+        LOG_INFO("Simulação finalizada");
+        LOG_INFO("Passadas de escalonamento: " << passadasEscalonamento);
+        LOG_INFO("Operações no conjunto de eventos: " << escalonador->getInsercoes() << " inserções, "
+                  << escalonador->getRemocoes() << " remoções, "
+                  << escalonador->getEventosImediatos() << " pela via imediata");
+        LOG_INFO("Maior número de eventos pendentes: " << escalonador->getMaiorTamanho());
+        if (pacientes.temHistorico()) {
+            LOG_INFO("Registros no histórico de atendimentos: " << pacientes.getTotalRegistros());
+        }
+        if (escritorAltas != nullptr) {
+            LOG_INFO("Posições no cadastro de pacientes: " << pacientes.size());
+        }
+
+        for(int i = 0; i < TOTAL_PROCEDIMENTOS; i++) {
+            Procedimento* proc = gerenciadorProcedimentos->getProcedimento(i);
+            LOG_INFO("Utilização de " << proc->getNome() << ": "
+                      << proc->getUtilizacao(escalonador->getTempoAtual()) * 100 << "%");
+        }
+        return true;
     }
 
-    std::string formatarTimestamp(long int timestamp) {
-        time_t tempo = static_cast<time_t>(timestamp);
-        struct tm* tm = localtime(&tempo);
-        char buffer[100];
-        strftime(buffer, sizeof(buffer), "%a %b %-d %H:%M:%S %Y", tm);
-        return std::string(buffer);
+    // Liga o relatório na alta, escrito em saida durante a simulação
+    void iniciaRelatorioNaAlta(std::ostream& saida) {
+        escritorAltas = new EscritorRelatorio(saida);
     }
-    
-    void geraRelatorio() {
-        for (int i = 0; i < pacientes.size(); i++) {
-            Paciente* paciente = pacientes[i];
-            
-            // Get admission time components
-            tm admissionTime = {};
-            time_t admissionSeconds = (paciente->getHoraChegada()) * 3600 - 71760 + // hours to seconds
-                                    paciente->getDiaChegado() * 24 * 3600 + // days to seconds
-                                    (paciente->getMesChegado() - 2) * 30 * 24 * 3600 + // months to seconds (approximate)
-                                    (paciente->getAnoChegado() + 73) * 365 * 24 * 3600; // years to seconds
-
-            formatarTimestamp(admissionSeconds);
-                        
-            // Get discharge time
-            double totalTime = paciente->getTempoTotalEspera() + paciente->getTempoTotalAtendimento();
-            // time_t dischargeSeconds = admissionSeconds + (time_t)(totalTime * 3600);
-            // tm dischargeTime = *localtime(&dischargeSeconds);
-            
-            // // Format day names
-            // char admissionDay[4], dischargeDay[4];
-            // strftime(admissionDay, sizeof(admissionDay), "%a", &admissionTime);
-            // strftime(dischargeDay, sizeof(dischargeDay), "%a", &dischargeTime);
-            
-            // // Format month names
-            // char admissionMonth[4], dischargeMonth[4];
-            // strftime(admissionMonth, sizeof(admissionMonth), "%b", &admissionTime);
-            // strftime(dischargeMonth, sizeof(dischargeMonth), "%b", &dischargeTime);
-            
-            // Print formatted output
-            cout << paciente->getId() << " " << formatarTimestamp(admissionSeconds) << " " << totalTime << " " << paciente->getTempoTotalAtendimento() << " " <<
-            paciente->getTempoTotalEspera() << endl;
+
+    // Escreve as linhas na ordem do cadastro. No relatório na alta só faltam
+    // os pacientes que ainda não saíram, depois das linhas já escritas.
+    void geraRelatorio(std::ostream& saida) {
+        if (escritorAltas != nullptr) {
+            escritorAltas->descarrega();
+        }
+
+        pacientes.preparaRelatorio();
+        EscritorRelatorio escritor(saida);
+        for (int paciente = 0; paciente < pacientes.size(); paciente++) {
+            if (pacientes.ocupado(paciente)) {
+                escreveLinhaRelatorio(escritor, paciente);
+            }
         }
+        escritor.descarrega();
     }
 };
 
+void imprimeUso(const char* programa) {
+    std::cerr << "Uso: " << programa << " [opções] <arquivo_entrada>\n"
+              << "Opções:\n"
+              << "  --eventos=heap|calendario|raias   estrutura dos eventos pendentes (padrão: heap)\n"
+              << "  --lote                            escalona uma vez por instante, após todos os eventos dele\n"
+              << "  --fluxo                           lê as chegadas sob demanda; exige o arquivo\n"
+              << "                                    ordenado por data e hora\n"
+              << "  --log=trace|debug|info|relatorio  diagnósticos mostrados em stderr (padrão: info)\n"
+              << "  --saida=assincrona|direta         grava por uma thread escritora ou direto pelos\n"
+              << "                                    fluxos padrão (padrão: assincrona se houver mais\n"
+              << "                                    de um núcleo)\n"
+              << "  --converte                        só grava a entrada no formato binário em\n"
+              << "                                    <arquivo_entrada>.bin\n"
+              << "  --relatorio=final|alta            gera o relatório no fim, na ordem da entrada, ou\n"
+              << "                                    escreve cada paciente na alta, na ordem das altas,\n"
+              << "                                    e recicla a sua memória (padrão: final); a memória\n"
+              << "                                    só fica limitada aos pacientes presentes com\n"
+              << "                                    --fluxo, pois sem ele todos são carregados no início\n"
+              << "  --sem-historico                   não guarda o histórico de atendimentos, só os\n"
+              << "                                    totais de espera e de atendimento\n"
+              << "  --cache                           carrega <arquivo_entrada>.bin, gerando-o antes\n"
+              << "                                    se não existir ou estiver desatualizado\n"
+              << "  --cadastro-em=<diretório>         guarda os pacientes em arquivos temporários\n"
+              << "                                    mapeados no diretório, para populações maiores\n"
+              << "                                    que a memória"
+              << std::endl;
+}
+
+// Com --cache: devolve o binário ao lado da entrada, regenerado se a entrada
+// mudou desde a conversão. Se não der para gravá-lo, segue com o texto.
+std::string arquivoParaCarga(const std::string& arquivoEntrada) {
+    std::string arquivoCache = arquivoEntrada + ".bin";
+    if(binarioAtualizado(arquivoEntrada, arquivoCache)) {
+        LOG_INFO("Usando o cache " << arquivoCache);
+        return arquivoCache;
+    }
+
+    std::string erro;
+    if(!converteParaBinario(arquivoEntrada, arquivoCache, erro)) {
+        LOG_ERRO("Aviso: cache não gerado (" << erro << "); lendo o texto");
+        return arquivoEntrada;
+    }
+    LOG_INFO("Cache " << arquivoCache << " gerado");
+    return arquivoCache;
+}
+
 int main(int argc, char* argv[]) {
-    if(argc != 2) {
-        std::cerr << "Uso: " << argv[0] << " <arquivo_entrada>" << std::endl;
+    // Só se usa iostream; sem sincronizar com stdio, cout e clog mantêm buffer próprio
+    std::ios::sync_with_stdio(false);
+
+    std::string arquivoEntrada;
+    int conjuntoEventos = Escalonador::CONJUNTO_HEAP;
+    bool emLote = false;
+    bool emFluxo = false;
+    bool soConverte = false;
+    bool usaCache = false;
+    bool comHistorico = true;
+    bool relatorioNaAlta = false;
+    std::string diretorioCadastro;
+    // Com um só núcleo a escritora disputa a CPU com a simulação e não compensa
+    bool saidaAssincrona = std::thread::hardware_concurrency() > 1;
+
+    for(int i = 1; i < argc; i++) {
+        std::string argumento = argv[i];
+        if(argumento == "--eventos=heap") {
+            conjuntoEventos = Escalonador::CONJUNTO_HEAP;
+        } else if(argumento == "--eventos=calendario") {
+            conjuntoEventos = Escalonador::CONJUNTO_CALENDARIO;
+        } else if(argumento == "--eventos=raias") {
+            conjuntoEventos = Escalonador::CONJUNTO_RAIAS;
+        } else if(argumento == "--lote") {
+            emLote = true;
+        } else if(argumento == "--fluxo") {
+            emFluxo = true;
+        } else if(argumento == "--converte") {
+            soConverte = true;
+        } else if(argumento == "--cache") {
+            usaCache = true;
+        } else if(argumento == "--relatorio=final") {
+            relatorioNaAlta = false;
+        } else if(argumento == "--relatorio=alta") {
+            relatorioNaAlta = true;
+        } else if(argumento == "--sem-historico") {
+            comHistorico = false;
+        } else if(argumento.compare(0, 14, "--cadastro-em=") == 0 && argumento.size() > 14) {
+            diretorioCadastro = argumento.substr(14);
+        } else if(argumento == "--saida=assincrona") {
+            saidaAssincrona = true;
+        } else if(argumento == "--saida=direta") {
+            saidaAssincrona = false;
+        } else if(argumento.compare(0, 6, "--log=") == 0 && nivelLogPorNome(argumento.substr(6)) >= 0) {
+            defineNivelLog(nivelLogPorNome(argumento.substr(6)));
+        } else if(argumento[0] == '-' || !arquivoEntrada.empty()) {
+            imprimeUso(argv[0]);
+            return 1;
+        } else {
+            arquivoEntrada = argumento;
+        }
+    }
+
+    if(arquivoEntrada.empty()) {
+        imprimeUso(argv[0]);
         return 1;
     }
 
-    std::cout << "Iniciando programa\n";
-    Hospital simulador;
-    
-    std::cout << "Carregando arquivo\n";
-    simulador.carregaArquivo(argv[1]);
-    
-    std::cout << "Executando simulação\n";
-    simulador.executaSimulacao();
+    // Sem o fluxo todo o cadastro já está alocado e as posições liberadas na
+    // alta não têm quem as reuse
+    if(relatorioNaAlta && !emFluxo && !soConverte) {
+        LOG_ERRO("Aviso: --relatorio=alta sem --fluxo não limita a memória, pois todos os"
+                 << " pacientes são carregados no início");
+    }
+
+    if(soConverte) {
+        std::string erro;
+        if(!converteParaBinario(arquivoEntrada, arquivoEntrada + ".bin", erro)) {
+            LOG_ERRO("Erro na conversão: " << erro);
+            return 1;
+        }
+        return 0;
+    }
+
+    if(!diretorioCadastro.empty()) {
+        std::string erro;
+        if(!MemoriaColunas::diretorioUtilizavel(diretorioCadastro, erro)) {
+            LOG_ERRO("Erro: " << erro);
+            return 1;
+        }
+    }
+
+    // Relatório em stdout e diagnósticos em stderr, cada um com a sua escritora
+    BufferAssincrono* bufferRelatorio = nullptr;
+    BufferAssincrono* bufferLog = nullptr;
+    std::ostream* relatorio = &std::cout;
+    if(saidaAssincrona) {
+        bufferRelatorio = new BufferAssincrono(1);
+        bufferLog = new BufferAssincrono(2);
+        relatorio = new std::ostream(bufferRelatorio);
+        defineFluxoLog(new std::ostream(bufferLog));
+    }
+
+    // O simulador é destruído antes dos fluxos de saída, que o relatório na
+    // alta usa até o fim. Falhas que só aparecem no meio da execução (chave
+    // de evento esgotada, disco cheio no cadastro em disco) chegam como exceção.
+    bool sucesso;
+    try {
+        LOG_INFO("Iniciando programa");
+        Hospital simulador(conjuntoEventos, emLote, emFluxo, comHistorico, diretorioCadastro);
+        if(relatorioNaAlta) {
+            simulador.iniciaRelatorioNaAlta(*relatorio);
+        }
 
-    std::cout << "Gerando relatório\n";
-    simulador.geraRelatorio();
+        LOG_INFO("Carregando arquivo");
+        sucesso = simulador.carregaArquivo(usaCache ? arquivoParaCarga(arquivoEntrada) : arquivoEntrada);
 
-    std::cout << "Programa finalizado\n";
-    return 0;
+        if(sucesso) {
+            LOG_INFO("Executando simulação");
+            sucesso = simulador.executaSimulacao();
+        }
+
+        if(sucesso) {
+            LOG_INFO("Gerando relatório");
+            std::chrono::steady_clock::time_point inicioRelatorio = std::chrono::steady_clock::now();
+            simulador.geraRelatorio(*relatorio);
+            relatorio->flush();
+            LOG_INFO("Relatório gerado em " << std::chrono::duration<double>(std::chrono::steady_clock::now() - inicioRelatorio).count() << " s");
+
+            LOG_INFO("Programa finalizado");
+        }
+    } catch(const std::exception& e) {
+        LOG_ERRO("Erro: " << e.what());
+        sucesso = false;
+    }
+
+    if(saidaAssincrona) {
+        bool gravou = bufferRelatorio->fecha() && bufferLog->fecha();
+        delete relatorio;
+        delete fluxoLog;
+        delete bufferRelatorio;
+        delete bufferLog;
+        defineFluxoLog(&std::clog);
+        if(!gravou) {
+            LOG_ERRO("Erro ao gravar a saída");
+            return 1;
+        }
+    }
+    return sucesso ? 0 : 1;
 };
\ No newline at end of file
@@ -0,0 +1,588 @@
+#pragma once
+
+#include <charconv>
+#include <string>
+#include <thread>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "Binario.cpp"
+#include "Paciente.cpp"
+
+// Leitura do arquivo de entrada mapeado em memória. O cabeçalho
+// (configurações e número de pacientes) é lido em sequência; a seção dos
+// pacientes, um por linha, é dividida em partes alinhadas a quebras de
+// linha e analisada em paralelo com std::from_chars, direto num bloco
+// reservado do cadastro de pacientes. No modo em fluxo os pacientes são lidos um a um,
+// conforme a simulação precisa deles. Os erros citam o número da linha no
+// arquivo.
+// Um arquivo no formato de Binario.cpp é reconhecido pela assinatura e
+// lido direto dos registros mapeados, sem análise de texto.
+class LeitorEntrada {
+private:
+    static const int CAMPOS_PACIENTE = 11;
+    static const std::size_t TAMANHO_MINIMO_PARTE = 1 << 20;
+    static const std::size_t TAMANHO_DESCARTE = 8 << 20;
+
+    std::string nome;     // Arquivo aberto, para as mensagens
+    int fd;
+    const char* dados;
+    std::size_t tamanho;
+    const char* cursor;   // Posição da leitura sequencial
+    const char* fim;
+    int linhaAtual;       // Linha de cursor, a partir de 1
+    int restantes;        // Registros ainda não lidos no modo em fluxo
+    int linhaLida;        // Linha do último registro lido no modo em fluxo
+    std::string erro;
+
+    const CabecalhoBinario* binario;    // nullptr se a entrada for texto
+    const RegistroBinario* registros;
+    int registroLido;                   // Índice do próximo registro no modo em fluxo
+    const char* descartadoAte;          // Páginas já devolvidas no modo em fluxo
+
+    // Trecho da seção de pacientes analisado por uma thread
+    struct Parte {
+        const char* inicio;
+        const char* fim;
+        int linhas;            // Quebras de linha no trecho
+        int registros;         // Linhas não vazias
+        int primeiraLinha;     // Número no arquivo da primeira linha do trecho
+        int primeiroPaciente;  // Índice no bloco do primeiro registro do trecho
+        int linhaErro;         // -1 se não houve erro
+        std::string erro;
+    };
+
+    static bool espaco(char c) {
+        return c == ' ' || c == '\t' || c == '\r';
+    }
+
+    static bool unidadesValidas(int unidades) {
+        return unidades >= 1 && unidades <= MAX_UNIDADES;
+    }
+
+    static std::string mensagemUnidades(int procedimento) {
+        return std::string("número de unidades de ") + nomeProcedimento(procedimento) +
+               " fora de 1 a " + std::to_string(MAX_UNIDADES);
+    }
+
+    bool falha(int linha, const std::string& mensagem) {
+        erro = "linha " + std::to_string(linha) + ": " + mensagem;
+        return false;
+    }
+
+    // Avança até o próximo campo do cabeçalho, que pode estar em outra linha
+    bool proximoCampo() {
+        while (cursor < fim && (espaco(*cursor) || *cursor == '\n')) {
+            if (*cursor == '\n') linhaAtual++;
+            cursor++;
+        }
+        return cursor < fim;
+    }
+
+    template <typename T>
+    bool leCampo(T& valor, const char* descricao) {
+        if (!proximoCampo()) {
+            return falha(linhaAtual, std::string("fim do arquivo, esperado ") + descricao);
+        }
+        std::from_chars_result r = std::from_chars(cursor, fim, valor);
+        if (r.ec != std::errc() || (r.ptr < fim && !espaco(*r.ptr) && *r.ptr != '\n')) {
+            return falha(linhaAtual, std::string("valor inválido, esperado ") + descricao);
+        }
+        cursor = r.ptr;
+        return true;
+    }
+
+    static void contaLinhas(Parte& parte) {
+        parte.linhas = 0;
+        parte.registros = 0;
+        bool vazia = true;
+        for (const char* p = parte.inicio; p < parte.fim; p++) {
+            if (*p == '\n') {
+                parte.linhas++;
+                if (!vazia) parte.registros++;
+                vazia = true;
+            } else if (!espaco(*p)) {
+                vazia = false;
+            }
+        }
+        if (!vazia) parte.registros++;   // Última linha sem quebra
+    }
+
+    // Lê os campos de uma linha de paciente a partir de p, parando na quebra
+    // de linha. Devolve quantos campos leu (0 numa linha vazia) ou -1 com a
+    // mensagem em erro.
+    static int analisaLinha(const char*& p, const char* fim, int* campos, std::string& erro) {
+        int lidos = 0;
+        while (true) {
+            while (p < fim && espaco(*p)) p++;
+            if (p == fim || *p == '\n') break;
+            if (lidos == CAMPOS_PACIENTE) {
+                erro = "mais de " + std::to_string(CAMPOS_PACIENTE) + " campos";
+                return -1;
+            }
+            std::from_chars_result r = std::from_chars(p, fim, campos[lidos]);
+            if (r.ec != std::errc() || (r.ptr < fim && !espaco(*r.ptr) && *r.ptr != '\n')) {
+                erro = "campo " + std::to_string(lidos + 1) + " não é um inteiro válido";
+                return -1;
+            }
+            p = r.ptr;
+            lidos++;
+        }
+
+        if (lidos > 0 && lidos < CAMPOS_PACIENTE) {
+            erro = "esperados " + std::to_string(CAMPOS_PACIENTE) + " campos, encontrados " +
+                   std::to_string(lidos);
+            return -1;
+        }
+        return lidos;
+    }
+
+    static Prontuario criaProntuario(const int* campos) {
+        Prontuario p;
+        p.id = campos[0];
+        p.alta = campos[1];
+        p.ano = campos[2];
+        p.mes = campos[3];
+        p.dia = campos[4];
+        p.hora = campos[5];
+        p.grau = campos[6];
+        p.medidas = campos[7];
+        p.testes = campos[8];
+        p.imagem = campos[9];
+        p.instrumentos = campos[10];
+        p.tempoAdmissao = ticksDaData(p.ano, p.mes, p.dia, p.hora);
+        return p;
+    }
+
+    // Analisa as linhas da parte; os registros além de numPacientes são ignorados
+    static void analisaParte(Parte& parte, CadastroPacientes& pacientes, int primeiroIndice, int numPacientes) {
+        const char* p = parte.inicio;
+        int linha = parte.primeiraLinha;
+        int registro = parte.primeiroPaciente;
+
+        while (p < parte.fim && registro < numPacientes) {
+            int campos[CAMPOS_PACIENTE];
+            int lidos = analisaLinha(p, parte.fim, campos, parte.erro);
+            if (lidos < 0) {
+                parte.linhaErro = linha;
+                return;
+            }
+
+            if (lidos == CAMPOS_PACIENTE) {
+                Prontuario prontuario = criaProntuario(campos);
+                if (!CadastroPacientes::prontuarioValido(prontuario, parte.erro)) {
+                    parte.linhaErro = linha;
+                    return;
+                }
+                pacientes.define(primeiroIndice + registro, prontuario);
+                registro++;
+            }
+
+            if (p < parte.fim) {   // Consome a quebra de linha
+                p++;
+                linha++;
+            }
+        }
+    }
+
+    static Prontuario criaProntuario(const RegistroBinario& r) {
+        Prontuario p;
+        p.id = r.id;
+        p.alta = r.alta;
+        p.ano = r.ano;
+        p.mes = r.mes;
+        p.dia = r.dia;
+        p.hora = r.hora;
+        p.grau = r.grau;
+        p.medidas = r.medidas;
+        p.testes = r.testes;
+        p.imagem = r.imagem;
+        p.instrumentos = r.instrumentos;
+        p.tempoAdmissao = r.tempoAdmissao;
+        return p;
+    }
+
+    // Prontuário do registro binário i; false se não couber no cadastro
+    bool leRegistro(int i, Prontuario& prontuario) {
+        prontuario = criaProntuario(registros[i]);
+        std::string mensagem;
+        if (!CadastroPacientes::prontuarioValido(prontuario, mensagem)) {
+            erro = "registro " + std::to_string(i + 1) + ": " + mensagem;
+            return false;
+        }
+        return true;
+    }
+
+    // Confere o cabeçalho binário e se o tamanho do arquivo bate com ele
+    bool validaBinario() {
+        if (tamanho < sizeof(CabecalhoBinario)) {
+            erro = "arquivo binário truncado no cabeçalho";
+            return false;
+        }
+        binario = (const CabecalhoBinario*)dados;
+        if (!cabecalhoBinarioValido(*binario, erro)) {
+            return false;
+        }
+        if (binario->numPacientes > (uint64_t)INT32_MAX ||
+            tamanho != sizeof(CabecalhoBinario) + binario->numPacientes * sizeof(RegistroBinario)) {
+            erro = "tamanho do arquivo binário não corresponde a " +
+                   std::to_string(binario->numPacientes) + " pacientes";
+            return false;
+        }
+        registros = (const RegistroBinario*)(dados + sizeof(CabecalhoBinario));
+        return true;
+    }
+
+    // No modo em fluxo o que já foi lido não volta a ser consultado: as
+    // páginas são devolvidas ao sistema para a memória residente não crescer
+    // com o tamanho do arquivo
+    void descartaLidos(const char* lidoAte) {
+        if ((std::size_t)(lidoAte - descartadoAte) < TAMANHO_DESCARTE) {
+            return;
+        }
+        std::size_t pagina = (std::size_t)sysconf(_SC_PAGESIZE);
+        const char* limite = dados + (std::size_t)(lidoAte - dados) / pagina * pagina;
+        madvise((void*)descartadoAte, limite - descartadoAte, MADV_DONTNEED);
+        descartadoAte = limite;
+    }
+
+    // Posiciona o cursor no início da seção de pacientes
+    bool iniciaSecaoPacientes(int numPacientes) {
+        if (binario != nullptr) {
+            restantes = numPacientes;
+            registroLido = 0;
+            return true;
+        }
+
+        if (numPacientes < 0) {
+            return falha(linhaAtual, "número de pacientes negativo");
+        }
+
+        // O restante da linha do número de pacientes precisa estar vazio
+        while (cursor < fim && espaco(*cursor)) cursor++;
+        if (cursor < fim && *cursor != '\n') {
+            return falha(linhaAtual, "conteúdo inesperado após o número de pacientes");
+        }
+        if (cursor < fim) {
+            cursor++;
+            linhaAtual++;
+        }
+        restantes = numPacientes;
+        return true;
+    }
+
+    template <typename Tarefa>
+    static void executaPartes(Parte* partes, int numPartes, Tarefa tarefa) {
+        if (numPartes == 1) {
+            tarefa(partes[0]);
+            return;
+        }
+
+        std::thread* threads = new std::thread[numPartes - 1];
+        for (int i = 1; i < numPartes; i++) {
+            threads[i - 1] = std::thread(tarefa, std::ref(partes[i]));
+        }
+        tarefa(partes[0]);
+        for (int i = 0; i < numPartes - 1; i++) {
+            threads[i].join();
+        }
+        delete[] threads;
+    }
+
+public:
+    LeitorEntrada()
+        : fd(-1), dados(nullptr), tamanho(0), cursor(nullptr), fim(nullptr), linhaAtual(1),
+          restantes(0), linhaLida(0), binario(nullptr), registros(nullptr), registroLido(0),
+          descartadoAte(nullptr) {}
+
+    ~LeitorEntrada() {
+        if (dados != nullptr) munmap((void*)dados, tamanho);
+        if (fd >= 0) close(fd);
+    }
+
+    bool abre(const std::string& nomeArquivo) {
+        nome = nomeArquivo;
+        fd = open(nomeArquivo.c_str(), O_RDONLY);
+        if (fd < 0) {
+            erro = "não foi possível abrir " + nomeArquivo;
+            return false;
+        }
+
+        struct stat info;
+        if (fstat(fd, &info) != 0) {
+            erro = "não foi possível consultar " + nomeArquivo;
+            return false;
+        }
+
+        tamanho = info.st_size;
+        if (tamanho > 0) {
+            void* mapa = mmap(nullptr, tamanho, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapa == MAP_FAILED) {
+                erro = "não foi possível mapear " + nomeArquivo;
+                return false;
+            }
+            dados = (const char*)mapa;
+            madvise(mapa, tamanho, MADV_SEQUENTIAL);
+        }
+        cursor = dados;
+        fim = dados + tamanho;
+        descartadoAte = dados;
+
+        if (tamanho >= sizeof(ASSINATURA_BINARIO) &&
+            std::memcmp(dados, ASSINATURA_BINARIO, sizeof(ASSINATURA_BINARIO)) == 0) {
+            return validaBinario();
+        }
+        return true;
+    }
+
+    bool ehBinario() const { return binario != nullptr; }
+
+    // Lê as configurações dos procedimentos (tempo e unidades, na ordem de
+    // ProcedimentoId) e o número de pacientes, em qualquer dos dois formatos
+    bool leCabecalho(double* tempos, int* unidades, int& numPacientes) {
+        if (binario != nullptr) {
+            for (int i = 0; i < TOTAL_PROCEDIMENTOS; i++) {
+                tempos[i] = binario->tempos[i];
+                unidades[i] = binario->unidades[i];
+                if (!unidadesValidas(unidades[i])) {
+                    erro = std::string("cabeçalho binário: ") + mensagemUnidades(i);
+                    return false;
+                }
+            }
+            numPacientes = (int)binario->numPacientes;
+            return true;
+        }
+
+        for (int i = 0; i < TOTAL_PROCEDIMENTOS; i++) {
+            if (!leCampo(tempos[i], "tempo do procedimento") ||
+                !leCampo(unidades[i], "número de unidades")) {
+                return false;
+            }
+            if (!unidadesValidas(unidades[i])) {
+                return falha(linhaAtual, mensagemUnidades(i));
+            }
+        }
+        return leCampo(numPacientes, "número de pacientes");
+    }
+
+    // Lê numPacientes registros a partir da linha seguinte ao cursor para
+    // um bloco novo de pacientes
+    bool lePacientes(CadastroPacientes& pacientes, int numPacientes) {
+        if (!iniciaSecaoPacientes(numPacientes)) {
+            return false;
+        }
+
+        if (binario != nullptr) {
+            int primeiroIndice = pacientes.reservaBloco(numPacientes);
+            for (int i = 0; i < numPacientes; i++) {
+                Prontuario prontuario;
+                if (!leRegistro(i, prontuario)) {
+                    return false;
+                }
+                pacientes.define(primeiroIndice + i, prontuario);
+            }
+            return true;
+        }
+
+        int numPartes = 1;
+        std::size_t tamanhoSecao = fim - cursor;
+        unsigned nucleos = std::thread::hardware_concurrency();
+        if (nucleos > 1 && tamanhoSecao / TAMANHO_MINIMO_PARTE > 1) {
+            std::size_t maximo = tamanhoSecao / TAMANHO_MINIMO_PARTE;
+            numPartes = (int)(maximo < nucleos ? maximo : nucleos);
+        }
+
+        // Divide a seção em partes que começam logo após uma quebra de linha
+        Parte* partes = new Parte[numPartes];
+        const char* inicio = cursor;
+        for (int i = 0; i < numPartes; i++) {
+            const char* limite = (i == numPartes - 1) ? fim : cursor + tamanhoSecao / numPartes * (i + 1);
+            if (limite < inicio) limite = inicio;
+            while (limite < fim && limite > inicio && limite[-1] != '\n') limite++;
+            partes[i].inicio = inicio;
+            partes[i].fim = limite;
+            partes[i].linhaErro = -1;
+            inicio = limite;
+        }
+
+        executaPartes(partes, numPartes, [](Parte& parte) { contaLinhas(parte); });
+
+        int linha = linhaAtual;
+        int registros = 0;
+        for (int i = 0; i < numPartes; i++) {
+            partes[i].primeiraLinha = linha;
+            partes[i].primeiroPaciente = registros;
+            linha += partes[i].linhas;
+            registros += partes[i].registros;
+        }
+
+        if (registros < numPacientes) {
+            delete[] partes;
+            return falha(linha, "esperados " + std::to_string(numPacientes) + " pacientes, encontrados " +
+                                std::to_string(registros));
+        }
+
+        int primeiroIndice = pacientes.reservaBloco(numPacientes);
+        executaPartes(partes, numPartes, [&pacientes, primeiroIndice, numPacientes](Parte& parte) {
+            analisaParte(parte, pacientes, primeiroIndice, numPacientes);
+        });
+
+        // Relata o primeiro erro do arquivo
+        for (int i = 0; i < numPartes; i++) {
+            if (partes[i].linhaErro >= 0) {
+                falha(partes[i].linhaErro, partes[i].erro);
+                delete[] partes;
+                return false;
+            }
+        }
+
+        delete[] partes;
+        return true;
+    }
+
+    // Modo em fluxo: prepara a leitura de numPacientes registros, um por vez
+    bool iniciaFluxo(int numPacientes) {
+        return iniciaSecaoPacientes(numPacientes);
+    }
+
+    // Lê o próximo paciente do fluxo para o cadastro e devolve o seu índice.
+    // Devolve -1 quando os registros declarados acabaram ou em erro; nesse
+    // caso getErro() não fica vazio.
+    int leProximoPaciente(CadastroPacientes& pacientes) {
+        if (restantes == 0) {
+            return -1;
+        }
+
+        if (binario != nullptr) {
+            Prontuario prontuario;
+            if (!leRegistro(registroLido, prontuario)) {
+                return -1;
+            }
+            restantes--;
+            registroLido++;
+            descartaLidos((const char*)(registros + registroLido));
+            return pacientes.adiciona(prontuario);
+        }
+
+        while (cursor < fim) {
+            int campos[CAMPOS_PACIENTE];
+            std::string mensagem;
+            int lidos = analisaLinha(cursor, fim, campos, mensagem);
+            if (lidos < 0) {
+                falha(linhaAtual, mensagem);
+                return -1;
+            }
+
+            int linhaRegistro = linhaAtual;
+            if (cursor < fim) {   // Consome a quebra de linha
+                cursor++;
+                linhaAtual++;
+            }
+
+            if (lidos == CAMPOS_PACIENTE) {
+                Prontuario prontuario = criaProntuario(campos);
+                if (!CadastroPacientes::prontuarioValido(prontuario, mensagem)) {
+                    falha(linhaRegistro, mensagem);
+                    return -1;
+                }
+                restantes--;
+                linhaLida = linhaRegistro;
+                descartaLidos(cursor);
+                return pacientes.adiciona(prontuario);
+            }
+        }
+
+        falha(linhaAtual, "faltam " + std::to_string(restantes) + " pacientes");
+        return -1;
+    }
+
+    // Posição do último paciente lido no modo em fluxo, para mensagens
+    std::string getPosicaoLida() const {
+        if (binario != nullptr) {
+            return "registro " + std::to_string(registroLido);
+        }
+        return "linha " + std::to_string(linhaLida);
+    }
+
+    const std::string& getErro() const { return erro; }
+    const std::string& getNome() const { return nome; }
+};
+
+inline bool cabeEmInt16(int valor) {
+    return valor >= INT16_MIN && valor <= INT16_MAX;
+}
+
+// Converte a entrada em texto de origem para o formato binário em destino,
+// guardando o tamanho e a data de modificação da origem para o cache
+inline bool converteParaBinario(const std::string& origem, const std::string& destino, std::string& erro) {
+    struct stat info;
+    if (stat(origem.c_str(), &info) != 0) {
+        erro = "não foi possível consultar " + origem;
+        return false;
+    }
+
+    LeitorEntrada leitor;
+    if (!leitor.abre(origem)) {
+        erro = leitor.getErro();
+        return false;
+    }
+    if (leitor.ehBinario()) {
+        erro = origem + " já está no formato binário";
+        return false;
+    }
+
+    CabecalhoBinario cabecalho;
+    std::memset(&cabecalho, 0, sizeof(cabecalho));
+    std::memcpy(cabecalho.assinatura, ASSINATURA_BINARIO, sizeof(ASSINATURA_BINARIO));
+    cabecalho.versao = VERSAO_BINARIO;
+    cabecalho.marcaOrdem = MARCA_ORDEM_BINARIO;
+    cabecalho.tamanhoOrigem = info.st_size;
+    cabecalho.modificacaoOrigem = modificacaoEmNs(info);
+
+    double tempos[TOTAL_PROCEDIMENTOS];
+    int unidades[TOTAL_PROCEDIMENTOS];
+    int numPacientes;
+    CadastroPacientes pacientes;
+    if (!leitor.leCabecalho(tempos, unidades, numPacientes) ||
+        !leitor.lePacientes(pacientes, numPacientes)) {
+        erro = leitor.getErro();
+        return false;
+    }
+    for (int i = 0; i < TOTAL_PROCEDIMENTOS; i++) {
+        cabecalho.tempos[i] = tempos[i];
+        cabecalho.unidades[i] = unidades[i];
+    }
+    cabecalho.numPacientes = numPacientes;
+
+    GravadorBinario gravador(destino);
+    gravador.gravaCabecalho(cabecalho);
+    for (int i = 0; i < pacientes.size(); i++) {
+        if (!cabeEmInt16(pacientes.getMesChegado(i)) || !cabeEmInt16(pacientes.getDiaChegado(i)) ||
+            !cabeEmInt16(pacientes.getHoraChegada(i))) {
+            erro = "paciente " + std::to_string(pacientes.getId(i)) +
+                   ": mês, dia ou hora fora do intervalo do formato binário";
+            return false;
+        }
+        RegistroBinario registro;
+        std::memset(&registro, 0, sizeof(registro));
+        registro.tempoAdmissao = pacientes.getTempoAdmissao(i);
+        registro.id = pacientes.getId(i);
+        registro.ano = pacientes.getAnoChegado(i);
+        registro.mes = (int16_t)pacientes.getMesChegado(i);
+        registro.dia = (int16_t)pacientes.getDiaChegado(i);
+        registro.hora = (int16_t)pacientes.getHoraChegada(i);
+        registro.grau = (int16_t)pacientes.getPrioridade(i);
+        registro.alta = pacientes.precisaAlta(i);
+        registro.medidas = pacientes.getQuantidadeMedidasHospitalares(i);
+        registro.testes = pacientes.getQuantidadeTestesLaboratorio(i);
+        registro.imagem = pacientes.getQuantidadeExamesImagem(i);
+        registro.instrumentos = pacientes.getQuantidadeInstrumentosMedicamentos(i);
+        gravador.gravaRegistro(registro);
+    }
+    if (!gravador.conclui()) {
+        erro = "não foi possível gravar " + destino;
+        return false;
+    }
+    return true;
+}
\ No newline at end of file
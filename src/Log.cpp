@@ -0,0 +1,57 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+
+// Mensagens de diagnóstico por nível. Vão para std::clog (stderr com
+// buffer) ou para o fluxo escolhido com defineFluxoLog, separadas do
+// relatório, que é o único conteúdo de stdout.
+// O nível mínimo é escolhido em tempo de execução; as mensagens de trace
+// somem da compilação quando NDEBUG está definido.
+enum NivelLog {
+    NIVEL_TRACE = 0,       // Uma linha por evento da simulação
+    NIVEL_DEBUG = 1,       // Situações pontuais de um paciente (alta)
+    NIVEL_INFO = 2,        // Progresso do programa e resumo da simulação
+    NIVEL_RELATORIO = 3    // Só o relatório final
+};
+
+static int nivelLogAtual = NIVEL_INFO;
+static std::ostream* fluxoLog = &std::clog;
+
+inline void defineNivelLog(int nivel) {
+    nivelLogAtual = nivel;
+}
+
+inline void defineFluxoLog(std::ostream* fluxo) {
+    fluxoLog = fluxo;
+}
+
+inline bool logAtivo(int nivel) {
+    return nivel >= nivelLogAtual;
+}
+
+// Converte o nome usado na linha de comando; -1 se não for um nível válido
+inline int nivelLogPorNome(const std::string& nome) {
+    if (nome == "trace") return NIVEL_TRACE;
+    if (nome == "debug") return NIVEL_DEBUG;
+    if (nome == "info") return NIVEL_INFO;
+    if (nome == "relatorio") return NIVEL_RELATORIO;
+    return -1;
+}
+
+// A mensagem só é formatada se o nível estiver ativo
+#define LOG_MENSAGEM(nivel, mensagem) \
+    do { if (logAtivo(nivel)) { *fluxoLog << mensagem << '\n'; } } while (0)
+
+#ifdef NDEBUG
+#define LOG_TRACE(mensagem) do { } while (0)
+#else
+#define LOG_TRACE(mensagem) LOG_MENSAGEM(NIVEL_TRACE, mensagem)
+#endif
+
+#define LOG_DEBUG(mensagem) LOG_MENSAGEM(NIVEL_DEBUG, mensagem)
+#define LOG_INFO(mensagem) LOG_MENSAGEM(NIVEL_INFO, mensagem)
+
+// Erros e avisos saem em qualquer nível, pelo mesmo fluxo das demais
+// mensagens, para não passarem à frente das que a escritora ainda grava
+#define LOG_ERRO(mensagem) do { *fluxoLog << mensagem << std::endl; } while (0)
\ No newline at end of file
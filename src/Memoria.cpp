@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+// Memória das colunas do cadastro de pacientes. Sem diretório, é memória
+// comum do processo. Com um diretório, cada região é um arquivo temporário
+// (já removido do diretório) mapeado com MAP_SHARED: o kernel pode gravar
+// as páginas no arquivo e tirá-las da RAM, o que permite populações maiores
+// que a memória. O espaço em disco é reservado na alocação, para que falte
+// ali (com exceção) e não na primeira escrita numa página, com SIGBUS no
+// meio da simulação. As regiões são sempre usadas inteiras e quem as pede
+// guarda o seu tamanho.
+class MemoriaColunas {
+private:
+    std::string diretorio;
+
+    void* mapeiaArquivo(std::size_t bytes) {
+        std::string modelo = diretorio + "/pacientes-XXXXXX";
+        int fd = mkstemp(&modelo[0]);
+        if (fd < 0) {
+            throw std::runtime_error("não foi possível criar arquivo em " + diretorio);
+        }
+        unlink(modelo.c_str());
+
+        int falha = posix_fallocate(fd, 0, (off_t)bytes);
+        if (falha != 0) {
+            close(fd);
+            throw std::runtime_error("não foi possível reservar " + std::to_string(bytes) +
+                                     " bytes em " + diretorio + ": " + std::strerror(falha));
+        }
+        void* mapa = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);   // O mapeamento mantém o arquivo
+        if (mapa == MAP_FAILED) {
+            throw std::runtime_error("não foi possível mapear " + std::to_string(bytes) + " bytes");
+        }
+        return mapa;
+    }
+
+public:
+    MemoriaColunas(const std::string& _diretorio = "") : diretorio(_diretorio) {}
+
+    bool emArquivo() const { return !diretorio.empty(); }
+
+    // Verifica se dá para criar os arquivos das colunas em diretorio
+    static bool diretorioUtilizavel(const std::string& diretorio, std::string& erro) {
+        std::string modelo = diretorio + "/pacientes-XXXXXX";
+        int fd = mkstemp(&modelo[0]);
+        if (fd < 0) {
+            erro = "não foi possível criar arquivos em " + diretorio;
+            return false;
+        }
+        unlink(modelo.c_str());
+        close(fd);
+        return true;
+    }
+
+    void* aloca(std::size_t bytes) {
+        if (bytes == 0) bytes = 1;
+        if (emArquivo()) {
+            return mapeiaArquivo(bytes);
+        }
+        return new char[bytes];
+    }
+
+    void libera(void* regiao, std::size_t bytes) {
+        if (regiao == nullptr) return;
+        if (emArquivo()) {
+            munmap(regiao, bytes == 0 ? 1 : bytes);
+        } else {
+            delete[] (char*)regiao;
+        }
+    }
+
+    // Troca a região por outra de bytesNovos, copiando os usados primeiros bytes
+    void* realoca(void* regiao, std::size_t usados, std::size_t bytes, std::size_t bytesNovos) {
+        void* nova = aloca(bytesNovos);
+        std::memcpy(nova, regiao, usados);
+        libera(regiao, bytes);
+        return nova;
+    }
+
+    // Repassa um conselho de madvise sobre a região; só vale para as regiões
+    // em arquivo, que começam alinhadas a página
+    void aconselha(void* regiao, std::size_t bytes, int conselho) {
+        if (emArquivo() && regiao != nullptr && bytes > 0) {
+            madvise(regiao, bytes, conselho);
+        }
+    }
+
+    // O mesmo para os bytes de inicio a fim da região, arredondados para
+    // baixo até a página, para não alcançar o que vem depois de fim
+    void aconselhaTrecho(void* regiao, std::size_t inicio, std::size_t fim, int conselho) {
+        static const std::size_t pagina = (std::size_t)sysconf(_SC_PAGESIZE);
+        inicio -= inicio % pagina;
+        fim -= fim % pagina;
+        if (fim > inicio) {
+            aconselha((char*)regiao + inicio, fim - inicio, conselho);
+        }
+    }
+};
\ No newline at end of file
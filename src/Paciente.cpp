@@ -1,51 +1,134 @@
+#pragma once
+
+#include <climits>
+#include <cstdint>
 #include <stdexcept>
 #include <string>
+#include "Memoria.cpp"
+#include "Tipos.cpp"
 
-class Paciente {
-private:
-    // Informações do prontuário
+// Dados de um paciente como vêm da entrada (texto ou binário), antes de
+// entrar no cadastro
+struct Prontuario {
     int id;
     bool alta;
     int ano;
     int mes;
     int dia;
-    double hora;
-    int grau;  // 0-Verde, 1-Amarelo, 2-Vermelho
-    
-    // Quantidade de procedimentos necessários
-    int medidasHospitalares;
-    int testesLaboratorio;
-    int examesImagem;
-    int instrumentosMedicamentos;
-    
-    // Estado atual do paciente
-    int estadoAtual;
-    
-    // Tempos e estatísticas
-    double tempoChegada;           // Momento que chegou ao hospital
-    double tempoUltimaTransicao;   // Última vez que mudou de estado
-    double tempoTotalEspera;       // Tempo total em filas
-    double tempoTotalAtendimento;  // Tempo total sendo atendido
-    double tempoSaida;             // Momento que saiu do hospital
-    
-    // Histórico de atendimentos usando lista encadeada
-    struct RegistroAtendimento {
-        std::string procedimento;
-        double inicio;
-        double fim;
-        bool emEspera;  // true se está na fila, false se está sendo atendido
-        RegistroAtendimento* proximo;
-        
-        RegistroAtendimento(const std::string& proc, double ini, bool espera)
-            : procedimento(proc), inicio(ini), fim(0), emEspera(espera), proximo(nullptr) {}
+    int hora;
+    int grau;           // 0-Verde, 1-Amarelo, 2-Vermelho
+    int medidas;        // Quantidade de cada procedimento necessário
+    int testes;
+    int imagem;
+    int instrumentos;
+    Tempo tempoAdmissao;
+};
+
+// Histórico de atendimentos de todos os pacientes numa arena só de
+// acréscimos, em blocos de tamanho fixo que nunca são movidos. Os registros
+// de um paciente formam uma lista encadeada por índices dentro da arena.
+class HistoricoAtendimentos {
+public:
+    struct Registro {
+        Tempo inicio;
+        Tempo fim;
+        int proximo;          // Próximo registro do mesmo paciente, -1 no último
+        int8_t procedimento;  // ProcedimentoId
+        bool emEspera;        // true se está na fila, false se está sendo atendido
     };
-    
-    RegistroAtendimento* primeiroRegistro;
-    RegistroAtendimento* ultimoRegistro;
 
+private:
+    static const int BITS_BLOCO = 16;
+    static const int TAMANHO_BLOCO = 1 << BITS_BLOCO;
+
+    MemoriaColunas& memoria;
+    Registro** blocos;
+    int numBlocos;
+    int capacidadeBlocos;
+    int total;
+    int primeiroLivre;    // Registros devolvidos, encadeados por proximo; -1 se nenhum
+
+public:
+    HistoricoAtendimentos(MemoriaColunas& _memoria)
+        : memoria(_memoria), numBlocos(0), capacidadeBlocos(16), total(0), primeiroLivre(-1) {
+        blocos = new Registro*[capacidadeBlocos];
+    }
+
+    ~HistoricoAtendimentos() {
+        for (int i = 0; i < numBlocos; i++) {
+            memoria.libera(blocos[i], TAMANHO_BLOCO * sizeof(Registro));
+        }
+        delete[] blocos;
+    }
+
+    // Acrescenta um registro aberto (sem fim) e devolve o seu índice
+    int acrescenta(int procedimento, Tempo inicio, bool emEspera) {
+        int indice;
+        if (primeiroLivre >= 0) {
+            indice = primeiroLivre;
+            primeiroLivre = (*this)[indice].proximo;
+        } else {
+            if (total == numBlocos * TAMANHO_BLOCO) {
+                if (numBlocos == capacidadeBlocos) {
+                    Registro** novos = new Registro*[capacidadeBlocos * 2];
+                    for (int i = 0; i < numBlocos; i++) {
+                        novos[i] = blocos[i];
+                    }
+                    delete[] blocos;
+                    blocos = novos;
+                    capacidadeBlocos *= 2;
+                }
+                blocos[numBlocos++] = (Registro*)memoria.aloca(TAMANHO_BLOCO * sizeof(Registro));
+            }
+            indice = total++;
+        }
+
+        Registro& registro = (*this)[indice];
+        registro.inicio = inicio;
+        registro.fim = 0;
+        registro.proximo = -1;
+        registro.procedimento = (int8_t)procedimento;
+        registro.emEspera = emEspera;
+        return indice;
+    }
+
+    // Devolve a lista de registros de primeiro a ultimo para reuso
+    void devolve(int primeiro, int ultimo) {
+        (*this)[ultimo].proximo = primeiroLivre;
+        primeiroLivre = primeiro;
+    }
+
+    Registro& operator[](int indice) {
+        return blocos[indice >> BITS_BLOCO][indice & (TAMANHO_BLOCO - 1)];
+    }
+
+    const Registro& operator[](int indice) const {
+        return blocos[indice >> BITS_BLOCO][indice & (TAMANHO_BLOCO - 1)];
+    }
+
+    // Registros já criados na arena, inclusive os devolvidos
+    int tamanho() const { return total; }
+};
+
+// Cadastro dos pacientes em colunas: um array denso por campo, todos
+// endereçados pelo mesmo índice de 32 bits, que é o que eventos, filas e
+// procedimentos guardam. O estado consultado a cada evento (estado, grau,
+// fila e procedimentos restantes) fica empacotado em 8 bytes por paciente;
+// os campos do prontuário e as estatísticas ficam em colunas à parte e só
+// são tocados na carga, nas transições e no relatório.
+// Os totais de espera e de atendimento são mantidos a partir do início do
+// trecho atual (em fila ou em atendimento) de cada paciente. O histórico
+// completo é opcional: sem ele nenhum registro é guardado.
+// Uma posição liberada depois da alta é reaproveitada pelo próximo paciente
+// acrescentado, com os registros de histórico dela.
+// As colunas e a arena do histórico podem ficar em arquivos mapeados (ver
+// MemoriaColunas), para populações que não cabem na RAM. Nesse caso o
+// cadastro repassa ao kernel como cada coluna é usada em cada fase.
+class CadastroPacientes {
 public:
-    // Enumeração dos estados possíveis
+    // Estados possíveis de um paciente
     enum Estado {
+        LIVRE = 0,              // Posição liberada, à espera de outro paciente
         NAO_CHEGOU = 1,
         FILA_TRIAGEM = 2,
         SENDO_TRIADO = 3,
@@ -62,190 +145,412 @@ public:
         ALTA_HOSPITALAR = 14
     };
 
-    // Construtor
-    Paciente(int _id, bool _alta, int _ano, int _mes, int _dia, double _hora, 
-             int _grau, int _medidas, int _testes, int _exames, int _instrumentos)
-        : id(_id), alta(_alta), ano(_ano), mes(_mes), dia(_dia), hora(_hora),
-          grau(_grau), medidasHospitalares(_medidas), testesLaboratorio(_testes),
-          examesImagem(_exames), instrumentosMedicamentos(_instrumentos),
-          estadoAtual(NAO_CHEGOU), tempoChegada(0), tempoUltimaTransicao(0),
-          tempoTotalEspera(0), tempoTotalAtendimento(0), tempoSaida(0),
-          primeiroRegistro(nullptr), ultimoRegistro(nullptr) {}
+    // Limite da quantidade de cada procedimento, que é guardada em um byte
+    static const int MAX_QUANTIDADE = 255;
+
+private:
+    // Pacientes que saíram, a cada quantos o cadastro em arquivo avisa o kernel
+    static const int TRECHO_FRIO = 1 << 16;
+
+    struct EstadoQuente {
+        uint8_t estado;       // Estado
+        int8_t grau;          // Saturado em int8; as filas usam no máximo 64 níveis
+        int8_t fila;          // Id da fila em que está, -1 se em nenhuma
+        uint8_t alta;
+        uint8_t restantes[4]; // Medidas, testes, imagem e instrumentos por fazer
+    };
+
+    MemoriaColunas memoria;
+    int capacidade;
+    int tamanho;
+    int* livres;        // Pilha das posições liberadas
+    int numLivres;
+    int primeiroAtivo;  // Todas as posições antes desta já tiveram alta
+    int esfriadoAte;    // Até onde as colunas foram marcadas como frias
+
+    // Estado quente
+    EstadoQuente* quentes;
 
+    // Prontuário
+    int* ids;
+    int* anos;
+    int* meses;
+    int* dias;
+    int* horas;
+    Tempo* temposAdmissao;
 
-    // Construtor Padrão
+    // Marca de quem ainda não chegou. Qualquer instante, inclusive anterior
+    // a 1970, é uma chegada válida, por isso a marca é o menor Tempo.
+    static const Tempo SEM_CHEGADA = LLONG_MIN;
 
-    Paciente() {}
+    // Tempos e estatísticas (em ticks, ver Tipos.cpp)
+    Tempo* temposChegada;        // Momento que chegou ao hospital; SEM_CHEGADA antes disso
+    Tempo* temposSaida;          // Momento que saiu do hospital
+    Tempo* temposEspera;         // Tempo total em filas
+    Tempo* temposAtendimento;    // Tempo total sendo atendido
+    Tempo* iniciosTrecho;        // Início da espera ou do atendimento atual
+
+    // Histórico: primeiro e último registro de cada paciente na arena, -1 se
+    // não houver
+    bool comHistorico;
+    HistoricoAtendimentos historico;
+    int* primeirosRegistros;
+    int* ultimosRegistros;
+
+    template <typename T>
+    T* alocaColuna() {
+        return (T*)memoria.aloca((std::size_t)capacidade * sizeof(T));
+    }
+
+    template <typename T>
+    void liberaColuna(T* coluna) {
+        memoria.libera(coluna, (std::size_t)capacidade * sizeof(T));
+    }
+
+    template <typename T>
+    void realoca(T*& coluna, int novaCapacidade) {
+        coluna = (T*)memoria.realoca(coluna, (std::size_t)tamanho * sizeof(T),
+                                     (std::size_t)capacidade * sizeof(T),
+                                     (std::size_t)novaCapacidade * sizeof(T));
+    }
 
-    // Destrutor
-    ~Paciente() {
-        RegistroAtendimento* atual = primeiroRegistro;
-        while (atual != nullptr) {
-            RegistroAtendimento* proximo = atual->proximo;
-            delete atual;
-            atual = proximo;
+    template <typename T>
+    void aconselhaColuna(T* coluna, int conselho) {
+        memoria.aconselha(coluna, (std::size_t)capacidade * sizeof(T), conselho);
+    }
+
+    template <typename T>
+    void aconselhaPosicoes(T* coluna, int de, int ate, int conselho) {
+        memoria.aconselhaTrecho(coluna, (std::size_t)de * sizeof(T), (std::size_t)ate * sizeof(T), conselho);
+    }
+
+    // Na simulação só os pacientes ativos são tocados. Com a entrada em ordem
+    // de chegada eles formam uma janela que avança pelos índices; o que fica
+    // para trás só volta a ser lido no relatório, e o kernel pode tirá-lo da
+    // RAM primeiro.
+    void avancaAtivos() {
+        while (primeiroAtivo < tamanho &&
+               (quentes[primeiroAtivo].estado == ALTA_HOSPITALAR || quentes[primeiroAtivo].estado == LIVRE)) {
+            primeiroAtivo++;
         }
+        if (primeiroAtivo - esfriadoAte < TRECHO_FRIO) return;
+
+#ifdef MADV_COLD
+        aconselhaPosicoes(quentes, esfriadoAte, primeiroAtivo, MADV_COLD);
+        aconselhaPosicoes(ids, esfriadoAte, primeiroAtivo, MADV_COLD);
+        aconselhaPosicoes(temposAdmissao, esfriadoAte, primeiroAtivo, MADV_COLD);
+        aconselhaPosicoes(temposChegada, esfriadoAte, primeiroAtivo, MADV_COLD);
+        aconselhaPosicoes(temposSaida, esfriadoAte, primeiroAtivo, MADV_COLD);
+        aconselhaPosicoes(temposEspera, esfriadoAte, primeiroAtivo, MADV_COLD);
+        aconselhaPosicoes(temposAtendimento, esfriadoAte, primeiroAtivo, MADV_COLD);
+        aconselhaPosicoes(iniciosTrecho, esfriadoAte, primeiroAtivo, MADV_COLD);
+        aconselhaPosicoes(primeirosRegistros, esfriadoAte, primeiroAtivo, MADV_COLD);
+        aconselhaPosicoes(ultimosRegistros, esfriadoAte, primeiroAtivo, MADV_COLD);
+#endif
+        esfriadoAte = primeiroAtivo;
+    }
+
+    void garanteCapacidade(int minimo) {
+        if (minimo <= capacidade) return;
+
+        int novaCapacidade = capacidade * 2;
+        if (novaCapacidade < minimo) novaCapacidade = minimo;
+        realoca(quentes, novaCapacidade);
+        realoca(ids, novaCapacidade);
+        realoca(anos, novaCapacidade);
+        realoca(meses, novaCapacidade);
+        realoca(dias, novaCapacidade);
+        realoca(horas, novaCapacidade);
+        realoca(temposAdmissao, novaCapacidade);
+        realoca(temposChegada, novaCapacidade);
+        realoca(temposSaida, novaCapacidade);
+        realoca(temposEspera, novaCapacidade);
+        realoca(temposAtendimento, novaCapacidade);
+        realoca(iniciosTrecho, novaCapacidade);
+        realoca(primeirosRegistros, novaCapacidade);
+        realoca(ultimosRegistros, novaCapacidade);
+        realoca(livres, novaCapacidade);
+        capacidade = novaCapacidade;
+    }
+
+    static uint8_t quantidade(int valor) {
+        // Quantidades negativas equivalem a nenhum procedimento
+        return (uint8_t)(valor < 0 ? 0 : valor);
+    }
+
+    // Em fila: do primeiro entrarFila até o início do atendimento seguinte
+    static bool estadoDeEspera(int estado) {
+        return estado != LIVRE && estado != ALTA_HOSPITALAR && estado % 2 == 0;
+    }
+
+    static bool estadoDeAtendimento(int estado) {
+        return estado != NAO_CHEGOU && estado % 2 == 1;
     }
 
-    // Adiciona um novo registro ao histórico
-    void adicionarRegistro(const std::string& procedimento, double inicio, bool emEspera) {
-        RegistroAtendimento* novoRegistro = new RegistroAtendimento(procedimento, inicio, emEspera);
-        
-        if (primeiroRegistro == nullptr) {
-            primeiroRegistro = novoRegistro;
-            ultimoRegistro = novoRegistro;
+    // Encerra o trecho atual e abre um novo, no histórico se estiver ligado
+    void iniciaTrecho(int paciente, int procedimento, Tempo tempoAtual, bool emEspera) {
+        iniciosTrecho[paciente] = tempoAtual;
+        if (!comHistorico) return;
+
+        if (ultimosRegistros[paciente] >= 0) {
+            historico[ultimosRegistros[paciente]].fim = tempoAtual;
+        }
+        int novo = historico.acrescenta(procedimento, tempoAtual, emEspera);
+        if (primeirosRegistros[paciente] < 0) {
+            primeirosRegistros[paciente] = novo;
         } else {
-            ultimoRegistro->proximo = novoRegistro;
-            ultimoRegistro = novoRegistro;
+            historico[ultimosRegistros[paciente]].proximo = novo;
+        }
+        ultimosRegistros[paciente] = novo;
+    }
+
+public:
+    // Com diretorio não vazio, as colunas ficam em arquivos temporários
+    // mapeados nesse diretório
+    CadastroPacientes(bool _comHistorico = true, const std::string& diretorio = "",
+                      int capacidadeInicial = 1000)
+        : memoria(diretorio), capacidade(capacidadeInicial), tamanho(0), numLivres(0),
+          primeiroAtivo(0), esfriadoAte(0), comHistorico(_comHistorico), historico(memoria) {
+        quentes = alocaColuna<EstadoQuente>();
+        ids = alocaColuna<int>();
+        anos = alocaColuna<int>();
+        meses = alocaColuna<int>();
+        dias = alocaColuna<int>();
+        horas = alocaColuna<int>();
+        temposAdmissao = alocaColuna<Tempo>();
+        temposChegada = alocaColuna<Tempo>();
+        temposSaida = alocaColuna<Tempo>();
+        temposEspera = alocaColuna<Tempo>();
+        temposAtendimento = alocaColuna<Tempo>();
+        iniciosTrecho = alocaColuna<Tempo>();
+        primeirosRegistros = alocaColuna<int>();
+        ultimosRegistros = alocaColuna<int>();
+        livres = alocaColuna<int>();
+    }
+
+    ~CadastroPacientes() {
+        liberaColuna(quentes);
+        liberaColuna(ids);
+        liberaColuna(anos);
+        liberaColuna(meses);
+        liberaColuna(dias);
+        liberaColuna(horas);
+        liberaColuna(temposAdmissao);
+        liberaColuna(temposChegada);
+        liberaColuna(temposSaida);
+        liberaColuna(temposEspera);
+        liberaColuna(temposAtendimento);
+        liberaColuna(iniciosTrecho);
+        liberaColuna(primeirosRegistros);
+        liberaColuna(ultimosRegistros);
+        liberaColuna(livres);
+    }
+
+    // Confere se o prontuário cabe no cadastro; false com a mensagem em erro
+    static bool prontuarioValido(const Prontuario& p, std::string& erro) {
+        if (p.medidas > MAX_QUANTIDADE || p.testes > MAX_QUANTIDADE ||
+            p.imagem > MAX_QUANTIDADE || p.instrumentos > MAX_QUANTIDADE) {
+            erro = "quantidade de procedimentos acima de " + std::to_string(MAX_QUANTIDADE);
+            return false;
         }
+        return true;
     }
 
+    // Acrescenta n posições e devolve o índice da primeira. Quem reserva
+    // preenche cada posição com define, inclusive em threads diferentes.
+    int reservaBloco(int n) {
+        garanteCapacidade(tamanho + n);
+        int primeiro = tamanho;
+        tamanho += n;
+        return primeiro;
+    }
+
+    // Acrescenta um paciente, numa posição liberada se houver, e devolve o
+    // seu índice
+    int adiciona(const Prontuario& prontuario) {
+        int indice = numLivres > 0 ? livres[--numLivres] : reservaBloco(1);
+        define(indice, prontuario);
+        return indice;
+    }
+
+    // Preenche a posição reservada com o prontuário, no estado inicial
+    void define(int i, const Prontuario& p) {
+        EstadoQuente& q = quentes[i];
+        q.estado = NAO_CHEGOU;
+        q.grau = (int8_t)(p.grau < INT8_MIN ? INT8_MIN : (p.grau > INT8_MAX ? INT8_MAX : p.grau));
+        q.fila = -1;
+        q.alta = p.alta;
+        q.restantes[0] = quantidade(p.medidas);
+        q.restantes[1] = quantidade(p.testes);
+        q.restantes[2] = quantidade(p.imagem);
+        q.restantes[3] = quantidade(p.instrumentos);
+
+        ids[i] = p.id;
+        anos[i] = p.ano;
+        meses[i] = p.mes;
+        dias[i] = p.dia;
+        horas[i] = p.hora;
+        temposAdmissao[i] = p.tempoAdmissao;
+
+        temposChegada[i] = SEM_CHEGADA;
+        temposSaida[i] = 0;
+        temposEspera[i] = 0;
+        temposAtendimento[i] = 0;
+        iniciosTrecho[i] = 0;
+        primeirosRegistros[i] = -1;
+        ultimosRegistros[i] = -1;
+    }
+
+    // Libera a posição de um paciente que não será mais consultado, com o
+    // seu histórico
+    void libera(int paciente) {
+        if (primeirosRegistros[paciente] >= 0) {
+            historico.devolve(primeirosRegistros[paciente], ultimosRegistros[paciente]);
+            primeirosRegistros[paciente] = -1;
+            ultimosRegistros[paciente] = -1;
+        }
+        quentes[paciente].estado = LIVRE;
+        livres[numLivres++] = paciente;
+    }
+
+    bool ocupado(int paciente) const { return quentes[paciente].estado != LIVRE; }
+
     // Métodos para transição de estado
-    void iniciarAtendimento(const std::string& procedimento, double tempoAtual) {
-        if (tempoChegada == 0) {
-            tempoChegada = tempoAtual;
+    void iniciarAtendimento(int paciente, int procedimento, Tempo tempoAtual) {
+        if (temposChegada[paciente] == SEM_CHEGADA) {
+            temposChegada[paciente] = tempoAtual;
         }
-        
-        // Registra fim do estado anterior se estava em espera
-        if (ultimoRegistro != nullptr && ultimoRegistro->emEspera) {
-            ultimoRegistro->fim = tempoAtual;
-            tempoTotalEspera += (tempoAtual - ultimoRegistro->inicio);
+
+        // Contabiliza a espera que termina agora
+        if (estadoDeEspera(quentes[paciente].estado)) {
+            temposEspera[paciente] += (tempoAtual - iniciosTrecho[paciente]);
         }
-        
+
         // Atualiza estado com base no procedimento
-        if (procedimento == "Triagem") estadoAtual = SENDO_TRIADO;
-        else if (procedimento == "Atendimento") estadoAtual = SENDO_ATENDIDO;
-        else if (procedimento == "Medidas") estadoAtual = REALIZANDO_MEDIDAS;
-        else if (procedimento == "Testes") estadoAtual = REALIZANDO_TESTES;
-        else if (procedimento == "Imagem") estadoAtual = REALIZANDO_EXAMES;
-        else if (procedimento == "Instrumentos/Medicamentos") estadoAtual = RECEBENDO_INSTRUMENTOS;
-        
+        static const uint8_t estadosAtendimento[TOTAL_PROCEDIMENTOS] = {
+            SENDO_TRIADO, SENDO_ATENDIDO, REALIZANDO_MEDIDAS,
+            REALIZANDO_TESTES, REALIZANDO_EXAMES, RECEBENDO_INSTRUMENTOS
+        };
+        if (procedimento >= 0 && procedimento < TOTAL_PROCEDIMENTOS) {
+            quentes[paciente].estado = estadosAtendimento[procedimento];
+        }
+
         // Registra novo atendimento
-        adicionarRegistro(procedimento, tempoAtual, false);
-        tempoUltimaTransicao = tempoAtual;
+        iniciaTrecho(paciente, procedimento, tempoAtual, false);
     }
 
-    void entrarFila(const std::string& procedimento, double tempoAtual) {
-        if (tempoChegada == 0) {
-            tempoChegada = tempoAtual;
+    void entrarFila(int paciente, int procedimento, Tempo tempoAtual) {
+        if (temposChegada[paciente] == SEM_CHEGADA) {
+            temposChegada[paciente] = tempoAtual;
         }
-        
-        // Registra fim do atendimento anterior se estava sendo atendido
-        if (ultimoRegistro != nullptr && !ultimoRegistro->emEspera) {
-            ultimoRegistro->fim = tempoAtual;
-            tempoTotalAtendimento += (tempoAtual - ultimoRegistro->inicio);
+
+        // Contabiliza o atendimento que termina agora
+        if (estadoDeAtendimento(quentes[paciente].estado)) {
+            temposAtendimento[paciente] += (tempoAtual - iniciosTrecho[paciente]);
         }
-        
+
         // Atualiza estado com base no procedimento
-        if (procedimento == "Triagem") estadoAtual = FILA_TRIAGEM;
-        else if (procedimento == "Atendimento") estadoAtual = FILA_ATENDIMENTO;
-        else if (procedimento == "Medidas") estadoAtual = FILA_MEDIDAS;
-        else if (procedimento == "Testes") estadoAtual = FILA_TESTES;
-        else if (procedimento == "Imagem") estadoAtual = FILA_EXAMES;
-        else if (procedimento == "Instrumentos/Medicamentos") estadoAtual = FILA_INSTRUMENTOS;
-        
-        // Sempre registra entrada na fila
-        adicionarRegistro(procedimento, tempoAtual, true);
-        tempoUltimaTransicao = tempoAtual;
-    }
-
-    void finalizarAtendimento(double tempoAtual) {
-        // Registra fim do último estado (seja espera ou atendimento)
-        if (ultimoRegistro != nullptr) {
-            ultimoRegistro->fim = tempoAtual;
-            if (ultimoRegistro->emEspera) {
-                tempoTotalEspera += (tempoAtual - ultimoRegistro->inicio);
-            } else {
-                tempoTotalAtendimento += (tempoAtual - ultimoRegistro->inicio);
-            }
+        static const uint8_t estadosFila[TOTAL_PROCEDIMENTOS] = {
+            FILA_TRIAGEM, FILA_ATENDIMENTO, FILA_MEDIDAS,
+            FILA_TESTES, FILA_EXAMES, FILA_INSTRUMENTOS
+        };
+        if (procedimento >= 0 && procedimento < TOTAL_PROCEDIMENTOS) {
+            quentes[paciente].estado = estadosFila[procedimento];
         }
-        
-        tempoSaida = tempoAtual;
-        estadoAtual = ALTA_HOSPITALAR;
-    }
-
-    // Métodos para verificar necessidade de procedimentos
-    bool precisaMedidasHospitalares() const { return medidasHospitalares > 0; }
-    bool precisaTestesLaboratorio() const { return testesLaboratorio > 0; }
-    bool precisaExamesImagem() const { return examesImagem > 0; }
-    bool precisaInstrumentosMedicamentos() const { return instrumentosMedicamentos > 0; }
-    bool precisaAlta() const { return alta; }
 
-    // Getters
-    int getId() const { return id; }
-    int getPrioridade() const { return grau; }
-    int getEstadoAtual() const { return estadoAtual; }
-    double getTempoChegada() const { return tempoChegada; }
-    double getTempoSaida() const { return tempoSaida; }
-    double getTempoTotalEspera() const { return tempoTotalEspera; }
-    double getTempoTotalAtendimento() const { return tempoTotalAtendimento; }
-    double getTempoPermanencia() const { return tempoSaida - tempoChegada; }
-    
-    int getAnoChegado() const { return ano; }
-    int getMesChegado() const { return mes; }
-    int getDiaChegado() const { return dia; }
-    int getHoraChegada() const { return hora; }
-
-    int getQuantidadeMedidasHospitalares() const { return medidasHospitalares; }
-    int getQuantidadeTestesLaboratorio() const { return testesLaboratorio; }
-    int getQuantidadeExamesImagem() const { return examesImagem; }
-    int getQuantidadeInstrumentosMedicamentos() const { return instrumentosMedicamentos; }
-
-    void setEstadoAtual(int novoEstado) { estadoAtual = novoEstado; }
-
-    // Método para decrementar contadores de procedimentos
-    void decrementarProcedimento(const std::string& procedimento) {
-        if (procedimento == "Medidas") medidasHospitalares--;
-        else if (procedimento == "Testes") testesLaboratorio--;
-        else if (procedimento == "Imagem") examesImagem--;
-        else if (procedimento == "Instrumentos/Medicamentos") instrumentosMedicamentos--;
+        // Sempre registra entrada na fila
+        iniciaTrecho(paciente, procedimento, tempoAtual, true);
     }
-};
 
-class PacienteArray {
-private:
-    Paciente** data;
-    int capacity;
-    int size_;
+    void finalizarAtendimento(int paciente, Tempo tempoAtual) {
+        // Contabiliza o último trecho (seja espera ou atendimento)
+        int estado = quentes[paciente].estado;
+        if (estadoDeEspera(estado)) {
+            temposEspera[paciente] += (tempoAtual - iniciosTrecho[paciente]);
+        } else if (estadoDeAtendimento(estado)) {
+            temposAtendimento[paciente] += (tempoAtual - iniciosTrecho[paciente]);
+        }
+        if (comHistorico && ultimosRegistros[paciente] >= 0) {
+            historico[ultimosRegistros[paciente]].fim = tempoAtual;
+        }
 
-public:
-    PacienteArray(int initialCapacity = 1000) : capacity(initialCapacity), size_(0) {
-        data = new Paciente*[capacity];
+        temposSaida[paciente] = tempoAtual;
+        quentes[paciente].estado = ALTA_HOSPITALAR;
+        if (paciente == primeiroAtivo && memoria.emArquivo()) {
+            avancaAtivos();
+        }
     }
 
-    ~PacienteArray() {
-        for (int i = 0; i < size_; i++) {
-            delete data[i];
-        }
-        delete[] data;
+    // Depois da carga: a data da admissão em partes só é lida de novo pela
+    // conversão para binário e pode ir logo para o disco
+    void concluiCarga() {
+#ifdef MADV_PAGEOUT
+        aconselhaColuna(anos, MADV_PAGEOUT);
+        aconselhaColuna(meses, MADV_PAGEOUT);
+        aconselhaColuna(dias, MADV_PAGEOUT);
+        aconselhaColuna(horas, MADV_PAGEOUT);
+#endif
     }
 
-    void push_back(Paciente* paciente) {
-        if (size_ == capacity) {
-            int newCapacity = capacity * 2;
-            Paciente** newData = new Paciente*[newCapacity];
-            
-            for (int i = 0; i < size_; i++) {
-                newData[i] = data[i];
-            }
-            
-            delete[] data;
-            data = newData;
-            capacity = newCapacity;
-        }
-        
-        data[size_] = paciente;
-        size_++;
+    // O relatório final lê as suas colunas em ordem, do início ao fim
+    void preparaRelatorio() {
+        aconselhaColuna(quentes, MADV_SEQUENTIAL);
+        aconselhaColuna(ids, MADV_SEQUENTIAL);
+        aconselhaColuna(temposAdmissao, MADV_SEQUENTIAL);
+        aconselhaColuna(temposEspera, MADV_SEQUENTIAL);
+        aconselhaColuna(temposAtendimento, MADV_SEQUENTIAL);
     }
 
-    Paciente* operator[](int index) {
-        if (index < 0 || index >= size_) {
-            throw std::out_of_range("Index out of bounds");
+    // Métodos para verificar necessidade de procedimentos
+    bool precisaMedidasHospitalares(int paciente) const { return quentes[paciente].restantes[0] > 0; }
+    bool precisaTestesLaboratorio(int paciente) const { return quentes[paciente].restantes[1] > 0; }
+    bool precisaExamesImagem(int paciente) const { return quentes[paciente].restantes[2] > 0; }
+    bool precisaInstrumentosMedicamentos(int paciente) const { return quentes[paciente].restantes[3] > 0; }
+    bool precisaAlta(int paciente) const { return quentes[paciente].alta; }
+
+    // Decrementa o contador do procedimento realizado
+    void decrementarProcedimento(int paciente, int procedimento) {
+        if (procedimento >= PROC_MEDIDAS && procedimento <= PROC_INSTRUMENTOS) {
+            quentes[paciente].restantes[procedimento - PROC_MEDIDAS]--;
         }
-        return data[index];
     }
 
+    // Getters
+    int getId(int paciente) const { return ids[paciente]; }
+    int getPrioridade(int paciente) const { return quentes[paciente].grau; }
+    int getEstadoAtual(int paciente) const { return quentes[paciente].estado; }
+    Tempo getTempoAdmissao(int paciente) const { return temposAdmissao[paciente]; }
+    Tempo getTempoChegada(int paciente) const { return temposChegada[paciente]; }
+    Tempo getTempoSaida(int paciente) const { return temposSaida[paciente]; }
+    Tempo getTempoTotalEspera(int paciente) const { return temposEspera[paciente]; }
+    Tempo getTempoTotalAtendimento(int paciente) const { return temposAtendimento[paciente]; }
+
+    int getAnoChegado(int paciente) const { return anos[paciente]; }
+    int getMesChegado(int paciente) const { return meses[paciente]; }
+    int getDiaChegado(int paciente) const { return dias[paciente]; }
+    int getHoraChegada(int paciente) const { return horas[paciente]; }
+
+    int getQuantidadeMedidasHospitalares(int paciente) const { return quentes[paciente].restantes[0]; }
+    int getQuantidadeTestesLaboratorio(int paciente) const { return quentes[paciente].restantes[1]; }
+    int getQuantidadeExamesImagem(int paciente) const { return quentes[paciente].restantes[2]; }
+    int getQuantidadeInstrumentosMedicamentos(int paciente) const { return quentes[paciente].restantes[3]; }
+
+    // Histórico do paciente: percorre-se de getPrimeiroRegistro seguindo
+    // Registro::proximo até -1. Vazio se o histórico estiver desligado.
+    bool temHistorico() const { return comHistorico; }
+    int getPrimeiroRegistro(int paciente) const { return primeirosRegistros[paciente]; }
+    const HistoricoAtendimentos::Registro& getRegistro(int indice) const { return historico[indice]; }
+    int getTotalRegistros() const { return historico.tamanho(); }
+
+    // Controle de pertença a filas, usado apenas pela Fila
+    int getFilaAtual(int paciente) const { return quentes[paciente].fila; }
+    void registraEntradaFila(int paciente, int fila) { quentes[paciente].fila = (int8_t)fila; }
+    void registraSaidaFila(int paciente) { quentes[paciente].fila = -1; }
+
+    // Posições em uso ou liberadas; os índices válidos vão de 0 a size() - 1
     int size() const {
-        return size_;
+        return tamanho;
     }
+
+    int getNumLivres() const { return numLivres; }
 };
\ No newline at end of file
@@ -1,26 +1,35 @@
 #include <string>
+#include "Tipos.cpp"
 
 class Procedimento {
 private:
-    std::string nome;              
-    double tempoMedio;             
+    int id;                        // ProcedimentoId
+    Tempo tempoMedio;              // Duração do procedimento em ticks
     int numeroUnidades;            
     
     struct Unidade {
         bool ocupada;
-        double tempoOcupadoAte;    
-        double tempoTotalOcupado;
-        double tempoTotalOcioso;
+        Tempo tempoOcupadoAte;     // Fim previsto da ocupação atual
+        Tempo inicioOcupacao;      // Início da ocupação atual
+        Tempo tempoTotalOcupado;   // Soma das ocupações já encerradas
         int pacienteId;            // ID do paciente que está ocupando a unidade
         int estadoAnterior;        // Estado anterior do paciente
         int estadoAtual;           // Estado atual do paciente
         
-        Unidade() : ocupada(false), tempoOcupadoAte(0), tempoTotalOcupado(0), 
-                   tempoTotalOcioso(0), pacienteId(-1), estadoAnterior(0), estadoAtual(0) {}
+        Unidade() : ocupada(false), tempoOcupadoAte(0), inicioOcupacao(0), 
+                   tempoTotalOcupado(0), pacienteId(-1), estadoAnterior(0), estadoAtual(0) {}
     };
     
     Unidade* unidades;             
 
+    // Pilha das unidades livres. Uma unidade só volta para ela quando o
+    // FIM_PROCEDIMENTO que carrega o seu índice a libera explicitamente.
+    int* livres;
+    int numLivres;
+
+    // Início do período observado, para calcular o tempo ocioso
+    Tempo inicioObservacao;
+
 public:
     // Enums para mapear estados do paciente aos procedimentos
     enum EstadoProcedimento {
@@ -33,111 +42,125 @@ public:
     };
 
     // Construtor
-    Procedimento(const std::string& nome, double tempoMedio, int numeroUnidades) 
-        : nome(nome), tempoMedio(tempoMedio), numeroUnidades(numeroUnidades) {
+    Procedimento(int id, Tempo tempoMedio, int numeroUnidades) 
+        : id(id), tempoMedio(tempoMedio), numeroUnidades(numeroUnidades),
+          numLivres(0), inicioObservacao(0) {
         unidades = new Unidade[numeroUnidades];
+        livres = new int[numeroUnidades];
+        // Empilha ao contrário para que a unidade 0 seja a primeira usada
+        for(int i = numeroUnidades - 1; i >= 0; i--) {
+            livres[numLivres++] = i;
+        }
     }
     
     // Destrutor
     ~Procedimento() {
         delete[] unidades;
+        delete[] livres;
     }
     
-    // Verifica se existe alguma unidade disponível no tempo atual
-    bool temUnidadeDisponivel(double tempoAtual) const {
-        for(int i = 0; i < numeroUnidades; i++) {
-            if(!unidades[i].ocupada || tempoAtual >= unidades[i].tempoOcupadoAte) {
-                return true;
-            }
-        }
-        return false;
-    }
-    
-    // Retorna o índice da primeira unidade disponível ou -1 se não houver
-    int getUnidadeDisponivel(double tempoAtual) const {
-        for(int i = 0; i < numeroUnidades; i++) {
-            if(!unidades[i].ocupada || tempoAtual >= unidades[i].tempoOcupadoAte) {
-                return i;
-            }
-        }
-        return -1;
+    // Verifica se existe alguma unidade livre, em O(1)
+    bool temUnidadeDisponivel() const {
+        return numLivres > 0;
     }
+
+    int getNumLivres() const { return numLivres; }
     
-    // Ocupa uma unidade com um paciente específico
-    bool ocuparUnidade(int indiceUnidade, double tempoAtual, int pacienteId, int estadoAnterior) {
-        if(indiceUnidade >= 0 && indiceUnidade < numeroUnidades) {
-            if(!unidades[indiceUnidade].ocupada || tempoAtual >= unidades[indiceUnidade].tempoOcupadoAte) {
-                unidades[indiceUnidade].ocupada = true;
-                unidades[indiceUnidade].tempoOcupadoAte = tempoAtual + tempoMedio;
-                unidades[indiceUnidade].pacienteId = pacienteId;
-                unidades[indiceUnidade].estadoAnterior = estadoAnterior;
-                unidades[indiceUnidade].estadoAtual = getEstadoProcedimento();
-                return true;
-            }
+    // Ocupa uma unidade livre com o paciente e devolve o índice dela, que deve
+    // ser passado a liberarUnidade no fim do atendimento; -1 se não houver
+    int ocuparUnidade(Tempo tempoAtual, int pacienteId, int estadoAnterior) {
+        if(numLivres == 0) {
+            return -1;
         }
-        return false;
-    }
-    
-    // Libera uma unidade e retorna o ID do paciente que estava nela
-    int liberarUnidade(int indiceUnidade, double tempoAtual) {
-        if(indiceUnidade >= 0 && indiceUnidade < numeroUnidades) {
-            if(unidades[indiceUnidade].ocupada) {
-                double tempoOcupado = tempoAtual - (unidades[indiceUnidade].tempoOcupadoAte - tempoMedio);
-                unidades[indiceUnidade].tempoTotalOcupado += tempoOcupado;
-                int pacienteId = unidades[indiceUnidade].pacienteId;
-                unidades[indiceUnidade].ocupada = false;
-                unidades[indiceUnidade].pacienteId = -1;
-                return pacienteId;
-            }
+
+        int indiceUnidade = livres[--numLivres];
+        Unidade& unidade = unidades[indiceUnidade];
+        unidade.ocupada = true;
+        unidade.tempoOcupadoAte = tempoAtual + tempoMedio;
+        unidade.inicioOcupacao = tempoAtual;
+        unidade.pacienteId = pacienteId;
+        unidade.estadoAnterior = estadoAnterior;
+        unidade.estadoAtual = getEstadoProcedimento();
+        return indiceUnidade;
+    }
+    
+    // Libera a unidade, contabilizando a ocupação até tempoAtual, e retorna o
+    // ID do paciente que estava nela (-1 se o índice não for de unidade ocupada)
+    int liberarUnidade(int indiceUnidade, Tempo tempoAtual) {
+        if(indiceUnidade >= 0 && indiceUnidade < numeroUnidades && unidades[indiceUnidade].ocupada) {
+            Unidade& unidade = unidades[indiceUnidade];
+            unidade.tempoTotalOcupado += tempoAtual - unidade.inicioOcupacao;
+            unidade.tempoOcupadoAte = tempoAtual;
+            int pacienteId = unidade.pacienteId;
+            unidade.ocupada = false;
+            unidade.pacienteId = -1;
+            livres[numLivres++] = indiceUnidade;
+            return pacienteId;
         }
         return -1;
     }
     
-    // Atualiza os tempos ociosos baseado no tempo atual
-    void atualizarTemposOciosos(double tempoAtual) {
-        for(int i = 0; i < numeroUnidades; i++) {
-            if(!unidades[i].ocupada || tempoAtual >= unidades[i].tempoOcupadoAte) {
-                unidades[i].tempoTotalOcioso += 1.0/60.0; // Adiciona 1 minuto convertido para hora
-            }
-        }
+    // Marca o início do período em que a ociosidade é contada
+    void iniciaObservacao(Tempo tempoAtual) {
+        inicioObservacao = tempoAtual;
     }
     
-    // Obtém o estado do procedimento baseado no nome
+    // Obtém o estado do procedimento baseado no identificador
     int getEstadoProcedimento() const {
-        if(nome == "Triagem") return TRIAGEM;
-        if(nome == "Atendimento") return ATENDIMENTO;
-        if(nome == "Medidas") return MEDIDAS;
-        if(nome == "Testes") return TESTES;
-        if(nome == "Imagem") return IMAGEM;
-        if(nome == "Instrumentos/Medicamentos") return INSTRUMENTOS;
-        return 0;
+        static const int estados[TOTAL_PROCEDIMENTOS] = {
+            TRIAGEM, ATENDIMENTO, MEDIDAS, TESTES, IMAGEM, INSTRUMENTOS
+        };
+        if(id < 0 || id >= TOTAL_PROCEDIMENTOS) return 0;
+        return estados[id];
     }
     
     // Getters básicos
-    std::string getNome() const { return nome; }
-    double getTempoMedio() const { return tempoMedio; }
+    int getId() const { return id; }
+    const char* getNome() const { return nomeProcedimento(id); }
+    Tempo getTempoMedio() const { return tempoMedio; }
     int getNumeroUnidades() const { return numeroUnidades; }
     
-    // Obter estatísticas de uma unidade
-    bool getEstadoUnidade(int indice, double& tempoOcupado, double& tempoOcioso) const {
+    // Obter estatísticas de uma unidade até tempoAtual. O tempo ocupado soma
+    // as ocupações encerradas e a parte já decorrida da atual; o ocioso é o
+    // restante do período observado.
+    bool getEstadoUnidade(int indice, Tempo tempoAtual, Tempo& tempoOcupado, Tempo& tempoOcioso) const {
         if(indice >= 0 && indice < numeroUnidades) {
-            tempoOcupado = unidades[indice].tempoTotalOcupado;
-            tempoOcioso = unidades[indice].tempoTotalOcioso;
+            const Unidade& unidade = unidades[indice];
+            tempoOcupado = unidade.tempoTotalOcupado;
+            if(unidade.ocupada && tempoAtual > unidade.inicioOcupacao) {
+                tempoOcupado += tempoAtual - unidade.inicioOcupacao;
+            }
+            tempoOcioso = (tempoAtual - inicioObservacao) - tempoOcupado;
+            if(tempoOcioso < 0) tempoOcioso = 0;
             return true;
         }
         return false;
     }
+
+    // Fração do tempo observado em que as unidades estiveram ocupadas
+    double getUtilizacao(Tempo tempoAtual) const {
+        Tempo periodo = tempoAtual - inicioObservacao;
+        if(numeroUnidades == 0 || periodo <= 0) return 0;
+
+        Tempo ocupadoTotal = 0;
+        for(int i = 0; i < numeroUnidades; i++) {
+            Tempo ocupado, ocioso;
+            getEstadoUnidade(i, tempoAtual, ocupado, ocioso);
+            ocupadoTotal += ocupado;
+        }
+        return (double)ocupadoTotal / ((double)periodo * numeroUnidades);
+    }
     
-    // Verifica se uma unidade está ocupada no tempo atual
-    bool isUnidadeOcupada(int indice, double tempoAtual) const {
+    // Verifica se uma unidade está ocupada
+    bool isUnidadeOcupada(int indice) const {
         if(indice >= 0 && indice < numeroUnidades) {
-            return unidades[indice].ocupada && tempoAtual < unidades[indice].tempoOcupadoAte;
+            return unidades[indice].ocupada;
         }
         return false;
     }
     
     // Obtém o tempo até quando a unidade está ocupada
-    double getTempoOcupadoAte(int indice) const {
+    Tempo getTempoOcupadoAte(int indice) const {
         if(indice >= 0 && indice < numeroUnidades) {
             return unidades[indice].tempoOcupadoAte;
         }
@@ -167,16 +190,6 @@ public:
         }
         return 0;
     }
-
-    // Retorna o índice da unidade ocupada por um paciente específico
-    int getUnidadeOcupada(int pacienteId) const {
-        for(int i = 0; i < numeroUnidades; i++) {
-            if(unidades[i].ocupada && unidades[i].pacienteId == pacienteId) {
-                return i;
-            }
-        }
-        return -1;
-    }
 };
 
 class GerenciadorProcedimentos {
@@ -186,14 +199,11 @@ private:
 
 public:
     // Construtor
-    GerenciadorProcedimentos() : numProcedimentos(6) {
+    GerenciadorProcedimentos() : numProcedimentos(TOTAL_PROCEDIMENTOS) {
         procedimentos = new Procedimento*[numProcedimentos];
-        procedimentos[0] = new Procedimento("Triagem", 0, 0);
-        procedimentos[1] = new Procedimento("Atendimento", 0, 0);
-        procedimentos[2] = new Procedimento("Medidas", 0, 0);
-        procedimentos[3] = new Procedimento("Testes", 0, 0);
-        procedimentos[4] = new Procedimento("Imagem", 0, 0);
-        procedimentos[5] = new Procedimento("Instrumentos/Medicamentos", 0, 0);
+        for(int i = 0; i < numProcedimentos; i++) {
+            procedimentos[i] = new Procedimento(i, 0, 0);
+        }
     }
     
     // Destrutor
@@ -205,31 +215,26 @@ public:
     }
     
     // Define o número de unidades para um procedimento
-    void setNumeroUnidades(const std::string& nome, double tempo, int numeroUnidades) {
-        for(int i = 0; i < numProcedimentos; i++) {
-            if(procedimentos[i]->getNome() == nome) {
-                Procedimento* novo = new Procedimento(nome, tempo, numeroUnidades);
-                delete procedimentos[i];
-                procedimentos[i] = novo;
-                break;
-            }
+    void setNumeroUnidades(int id, Tempo tempo, int numeroUnidades) {
+        if(id >= 0 && id < numProcedimentos) {
+            Procedimento* novo = new Procedimento(id, tempo, numeroUnidades);
+            delete procedimentos[id];
+            procedimentos[id] = novo;
         }
     }
     
-    // Obtém um procedimento pelo nome
-    Procedimento* getProcedimento(const std::string& nome) {
-        for(int i = 0; i < numProcedimentos; i++) {
-            if(procedimentos[i]->getNome() == nome) {
-                return procedimentos[i];
-            }
+    // Obtém um procedimento pelo identificador
+    Procedimento* getProcedimento(int id) {
+        if(id >= 0 && id < numProcedimentos) {
+            return procedimentos[id];
         }
         return nullptr;
     }
     
-    // Atualiza os tempos ociosos de todos os procedimentos
-    void atualizarTemposOciosos(double tempoAtual) {
+    // Marca o início da contagem de ociosidade de todos os procedimentos
+    void iniciaObservacao(Tempo tempoAtual) {
         for(int i = 0; i < numProcedimentos; i++) {
-            procedimentos[i]->atualizarTemposOciosos(tempoAtual);
+            procedimentos[i]->iniciaObservacao(tempoAtual);
         }
     }
 };
\ No newline at end of file
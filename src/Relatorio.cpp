@@ -0,0 +1,136 @@
+#pragma once
+
+#include <charconv>
+#include <cstring>
+#include <ostream>
+#include "Tipos.cpp"
+
+// Monta as linhas do relatório num buffer grande, sem alocar por linha e sem
+// localtime: as datas saem de Tempo (UTC) no formato de strftime
+// "%a %b %-d %H:%M:%S %Y". A parte que só depende do dia ("Thu Jul 6 " e
+// " 2017") fica num cache direto por dia, já que muitos pacientes chegam no
+// mesmo dia; os números são escritos com std::to_chars.
+class EscritorRelatorio {
+private:
+    static const std::size_t TAMANHO_BUFFER = 1 << 20;
+    static const std::size_t MAIOR_LINHA = 256;   // Folga para uma linha inteira
+    static const int POSICOES_CACHE = 1024;
+
+    struct DiaFormatado {
+        long long dia;        // Dias desde a época; vale se preenchido
+        bool preenchido;
+        char prefixo[16];     // "Thu Jul 6 "
+        int tamanhoPrefixo;
+        char sufixo[16];      // " 2017"
+        int tamanhoSufixo;
+    };
+
+    std::ostream& saida;
+    char* buffer;
+    std::size_t usado;
+    DiaFormatado* cache;
+
+    static long long diaDe(Tempo t) {
+        return t >= 0 ? t / TICKS_POR_DIA : -((-t + TICKS_POR_DIA - 1) / TICKS_POR_DIA);
+    }
+
+    const DiaFormatado& formataDia(long long dia) {
+        DiaFormatado& entrada = cache[(unsigned long long)dia % POSICOES_CACHE];
+        if (entrada.preenchido && entrada.dia == dia) {
+            return entrada;
+        }
+
+        static const char* const semana[7] = {"Thu", "Fri", "Sat", "Sun", "Mon", "Tue", "Wed"};
+        static const char* const meses[12] = {"Jan", "Feb", "Mar", "Apr", "May", "Jun",
+                                              "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"};
+        int ano, mes, diaMes;
+        dataDosDias(dia, ano, mes, diaMes);
+
+        // 1970-01-01 foi uma quinta-feira
+        int diaSemana = (int)(((dia % 7) + 7) % 7);
+        char* p = entrada.prefixo;
+        std::memcpy(p, semana[diaSemana], 3);
+        p[3] = ' ';
+        std::memcpy(p + 4, meses[mes - 1], 3);
+        p[7] = ' ';
+        p = std::to_chars(p + 8, entrada.prefixo + sizeof(entrada.prefixo) - 1, diaMes).ptr;
+        *p++ = ' ';
+        entrada.tamanhoPrefixo = (int)(p - entrada.prefixo);
+
+        entrada.sufixo[0] = ' ';
+        p = std::to_chars(entrada.sufixo + 1, entrada.sufixo + sizeof(entrada.sufixo), ano).ptr;
+        entrada.tamanhoSufixo = (int)(p - entrada.sufixo);
+
+        entrada.dia = dia;
+        entrada.preenchido = true;
+        return entrada;
+    }
+
+    static char* doisDigitos(char* p, int valor) {
+        p[0] = (char)('0' + valor / 10);
+        p[1] = (char)('0' + valor % 10);
+        return p + 2;
+    }
+
+    char* atual() { return buffer + usado; }
+    char* limite() { return buffer + TAMANHO_BUFFER; }
+
+public:
+    EscritorRelatorio(std::ostream& _saida) : saida(_saida), usado(0) {
+        buffer = new char[TAMANHO_BUFFER];
+        cache = new DiaFormatado[POSICOES_CACHE];
+        for (int i = 0; i < POSICOES_CACHE; i++) {
+            cache[i].preenchido = false;
+        }
+    }
+
+    ~EscritorRelatorio() {
+        descarrega();
+        delete[] cache;
+        delete[] buffer;
+    }
+
+    // Garante espaço para mais uma linha; chamado no início de cada linha
+    void iniciaLinha() {
+        if (TAMANHO_BUFFER - usado < MAIOR_LINHA) {
+            descarrega();
+        }
+    }
+
+    void escreveInteiro(long long valor) {
+        usado = std::to_chars(atual(), limite(), valor).ptr - buffer;
+    }
+
+    // Mesmo texto que operator<< com a precisão padrão de 6 dígitos (%g)
+    void escreveReal(double valor) {
+        usado = std::to_chars(atual(), limite(), valor, std::chars_format::general, 6).ptr - buffer;
+    }
+
+    void escreveData(Tempo t) {
+        long long dia = diaDe(t);
+        const DiaFormatado& formatado = formataDia(dia);
+        int segundos = (int)(t - dia * TICKS_POR_DIA);
+
+        char* p = atual();
+        std::memcpy(p, formatado.prefixo, formatado.tamanhoPrefixo);
+        p += formatado.tamanhoPrefixo;
+        p = doisDigitos(p, segundos / 3600);
+        *p++ = ':';
+        p = doisDigitos(p, segundos / 60 % 60);
+        *p++ = ':';
+        p = doisDigitos(p, segundos % 60);
+        std::memcpy(p, formatado.sufixo, formatado.tamanhoSufixo);
+        usado = p + formatado.tamanhoSufixo - buffer;
+    }
+
+    void escreveCaractere(char c) {
+        buffer[usado++] = c;
+    }
+
+    void descarrega() {
+        if (usado > 0) {
+            saida.write(buffer, usado);
+            usado = 0;
+        }
+    }
+};
\ No newline at end of file
@@ -0,0 +1,159 @@
+#pragma once
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <streambuf>
+#include <thread>
+#include <unistd.h>
+
+// Saída assíncrona para um descritor de arquivo, usada como streambuf de um
+// std::ostream. A thread da simulação formata direto no buffer corrente; um
+// buffer cheio entra num anel de NUM_BUFFERS posições (um produtor e um
+// consumidor, sem trava) e uma thread escritora o grava com write(2). A
+// simulação só espera quando todos os buffers do anel aguardam gravação.
+class BufferAssincrono : public std::streambuf {
+private:
+    static const unsigned NUM_BUFFERS = 8;
+    static const std::size_t TAMANHO_BUFFER = 1 << 16;
+
+    int fd;
+    char* buffers[NUM_BUFFERS];
+    std::size_t usados[NUM_BUFFERS];
+
+    // Contadores que só crescem; a posição no anel é o contador % NUM_BUFFERS
+    std::atomic<unsigned> entregues;   // Buffers publicados pela simulação
+    std::atomic<unsigned> gravados;    // Buffers já gravados pela escritora
+    std::atomic<bool> encerrando;
+    bool falhou;                       // Escrito só pela escritora, lido após o join
+
+    std::thread escritora;
+
+    // Espera ativa curta e depois cochilos, para a thread ociosa não ocupar um núcleo
+    static void aguarda(int& tentativas) {
+        if (++tentativas < 64) {
+            std::this_thread::yield();
+        } else {
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+    }
+
+    void iniciaBufferAtual() {
+        char* buffer = buffers[entregues.load(std::memory_order_relaxed) % NUM_BUFFERS];
+        setp(buffer, buffer + TAMANHO_BUFFER);
+    }
+
+    // Publica o buffer corrente e passa para o próximo do anel
+    void entrega() {
+        unsigned n = entregues.load(std::memory_order_relaxed);
+        usados[n % NUM_BUFFERS] = pptr() - pbase();
+        entregues.store(n + 1, std::memory_order_release);
+
+        int tentativas = 0;
+        while (n + 1 - gravados.load(std::memory_order_acquire) >= NUM_BUFFERS) {
+            aguarda(tentativas);
+        }
+        iniciaBufferAtual();
+    }
+
+    bool gravaTudo(const char* dados, std::size_t tamanho) {
+        while (tamanho > 0) {
+            ssize_t escrito = ::write(fd, dados, tamanho);
+            if (escrito < 0) {
+                if (errno == EINTR) continue;
+                return false;
+            }
+            dados += escrito;
+            tamanho -= escrito;
+        }
+        return true;
+    }
+
+    void executaEscritora() {
+        unsigned n = gravados.load(std::memory_order_relaxed);
+        int tentativas = 0;
+        while (true) {
+            if (entregues.load(std::memory_order_acquire) == n) {
+                // O último buffer é entregue antes de encerrando ser ligado
+                if (encerrando.load(std::memory_order_acquire) &&
+                    entregues.load(std::memory_order_acquire) == n) {
+                    break;
+                }
+                aguarda(tentativas);
+                continue;
+            }
+
+            tentativas = 0;
+            if (!falhou && !gravaTudo(buffers[n % NUM_BUFFERS], usados[n % NUM_BUFFERS])) {
+                falhou = true;
+            }
+            n++;
+            gravados.store(n, std::memory_order_release);
+        }
+    }
+
+protected:
+    int overflow(int c) override {
+        entrega();
+        if (c != traits_type::eof()) {
+            *pptr() = (char)c;
+            pbump(1);
+        }
+        return traits_type::not_eof(c);
+    }
+
+    std::streamsize xsputn(const char* dados, std::streamsize tamanho) override {
+        std::streamsize restante = tamanho;
+        while (restante > 0) {
+            std::streamsize espaco = epptr() - pptr();
+            if (espaco == 0) {
+                entrega();
+                continue;
+            }
+            std::streamsize parte = restante < espaco ? restante : espaco;
+            std::memcpy(pptr(), dados, parte);
+            pbump((int)parte);
+            dados += parte;
+            restante -= parte;
+        }
+        return tamanho;
+    }
+
+    // Um flush entrega o que já foi formatado, sem esperar a gravação
+    int sync() override {
+        if (pptr() > pbase()) {
+            entrega();
+        }
+        return 0;
+    }
+
+public:
+    BufferAssincrono(int _fd)
+        : fd(_fd), entregues(0), gravados(0), encerrando(false), falhou(false) {
+        for (unsigned i = 0; i < NUM_BUFFERS; i++) {
+            buffers[i] = new char[TAMANHO_BUFFER];
+            usados[i] = 0;
+        }
+        iniciaBufferAtual();
+        escritora = std::thread(&BufferAssincrono::executaEscritora, this);
+    }
+
+    ~BufferAssincrono() {
+        fecha();
+        for (unsigned i = 0; i < NUM_BUFFERS; i++) {
+            delete[] buffers[i];
+        }
+    }
+
+    // Entrega o restante e espera a escritora gravar tudo; false se alguma
+    // gravação falhou
+    bool fecha() {
+        if (escritora.joinable()) {
+            sync();
+            encerrando.store(true, std::memory_order_release);
+            escritora.join();
+        }
+        return !falhou;
+    }
+};
\ No newline at end of file
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <climits>
+#include <string>
+
+// Identificadores compactos dos procedimentos do hospital.
+// Os nomes (std::string) só aparecem na leitura e na escrita; internamente
+// o simulador trabalha com estes índices.
+enum ProcedimentoId {
+    PROC_TRIAGEM = 0,
+    PROC_ATENDIMENTO = 1,
+    PROC_MEDIDAS = 2,
+    PROC_TESTES = 3,
+    PROC_IMAGEM = 4,
+    PROC_INSTRUMENTOS = 5,
+    TOTAL_PROCEDIMENTOS = 6,
+    PROC_NENHUM = -1
+};
+
+// Limite de unidades de um procedimento: o índice da unidade ocupada viaja
+// num short dentro do Evento
+const int MAX_UNIDADES = SHRT_MAX;
+
+// Nome de exibição de cada procedimento, indexado por ProcedimentoId
+inline const char* nomeProcedimento(int id) {
+    static const char* const nomes[TOTAL_PROCEDIMENTOS] = {
+        "Triagem", "Atendimento", "Medidas",
+        "Testes", "Imagem", "Instrumentos/Medicamentos"
+    };
+    if(id < 0 || id >= TOTAL_PROCEDIMENTOS) return "";
+    return nomes[id];
+}
+
+// Converte o nome de um procedimento para o seu identificador
+inline int procedimentoPorNome(const std::string& nome) {
+    for(int i = 0; i < TOTAL_PROCEDIMENTOS; i++) {
+        if(nome == nomeProcedimento(i)) return i;
+    }
+    return PROC_NENHUM;
+}
+
+// Base de tempo do simulador: inteiro de segundos desde a época Unix
+// (1970-01-01 00:00, datas do arquivo tomadas como UTC). Durações usam a
+// mesma unidade; as horas só aparecem na entrada e na saída.
+typedef long long Tempo;
+
+const Tempo TICKS_POR_HORA = 3600;
+const Tempo TICKS_POR_DIA = 24 * TICKS_POR_HORA;
+
+inline Tempo horasParaTicks(double horas) {
+    double ticks = horas * TICKS_POR_HORA;
+    return (Tempo)(ticks < 0 ? ticks - 0.5 : ticks + 0.5);
+}
+
+inline double ticksParaHoras(Tempo ticks) {
+    return (double)ticks / TICKS_POR_HORA;
+}
+
+// Dias desde 1970-01-01 para uma data do calendário gregoriano
+// (algoritmo days_from_civil de Howard Hinnant)
+inline long long diasDesdeEpoca(int ano, int mes, int dia) {
+    ano -= mes <= 2;
+    long long era = (ano >= 0 ? ano : ano - 399) / 400;
+    unsigned anoDaEra = (unsigned)(ano - era * 400);
+    unsigned diaDoAno = (153 * (mes + (mes > 2 ? -3 : 9)) + 2) / 5 + dia - 1;
+    unsigned diaDaEra = anoDaEra * 365 + anoDaEra / 4 - anoDaEra / 100 + diaDoAno;
+    return era * 146097 + (long long)diaDaEra - 719468;
+}
+
+// Data do calendário gregoriano para dias desde 1970-01-01; inverso de
+// diasDesdeEpoca (civil_from_days, do mesmo autor)
+inline void dataDosDias(long long dias, int& ano, int& mes, int& dia) {
+    dias += 719468;
+    long long era = (dias >= 0 ? dias : dias - 146096) / 146097;
+    unsigned diaDaEra = (unsigned)(dias - era * 146097);
+    unsigned anoDaEra = (diaDaEra - diaDaEra / 1460 + diaDaEra / 36524 - diaDaEra / 146096) / 365;
+    unsigned diaDoAno = diaDaEra - (365 * anoDaEra + anoDaEra / 4 - anoDaEra / 100);
+    unsigned mp = (5 * diaDoAno + 2) / 153;
+    dia = (int)(diaDoAno - (153 * mp + 2) / 5 + 1);
+    mes = (int)(mp < 10 ? mp + 3 : mp - 9);
+    ano = (int)(anoDaEra + era * 400 + (mes <= 2));
+}
+
+inline Tempo ticksDaData(int ano, int mes, int dia, int hora) {
+    return diasDesdeEpoca(ano, mes, dia) * TICKS_POR_DIA + hora * TICKS_POR_HORA;
+}